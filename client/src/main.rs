@@ -100,10 +100,32 @@ fn print_json(input: &Input, json: &str) -> std::io::Result<()> {
                         );
                     } else {
                         println!(
-                            "{}: {} ({}) {}:{}",
-                            pier.id, pier.prefix, pier.face_id, pier.ip, pier.port
+                            "{}: {} ({}) {}:{} rtt {:.1}ms loss {:.0}% cost {} {} {}",
+                            pier.id,
+                            pier.prefix,
+                            pier.face_id,
+                            pier.ip,
+                            pier.port,
+                            pier.rtt_ms,
+                            pier.loss * 100.0,
+                            pier.cost,
+                            pier.link,
+                            pier.state
                         );
                     }
+                    if !pier.mac.is_empty() {
+                        println!("    ether [{}] (in use)", pier.mac);
+                    }
+                    if !pier.ip6.is_empty() {
+                        if pier.family == "udp6" {
+                            println!("    ipv6 [{}] (in use)", pier.ip6);
+                        } else {
+                            println!("    ipv6 [{}]", pier.ip6);
+                        }
+                    }
+                    for prefix in &pier.prefixes {
+                        println!("    also {}", prefix);
+                    }
                 }
             }
             Command::QueryRoute => {
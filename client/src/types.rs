@@ -150,4 +150,22 @@ pub struct Pier {
     pub prefix: String,
     pub ip: String,
     pub port: u64,
+    #[serde(default)]
+    pub prefixes: Vec<String>,
+    #[serde(default)]
+    pub rtt_ms: f64,
+    #[serde(default)]
+    pub loss: f64,
+    #[serde(default = "zero")]
+    pub cost: u64,
+    #[serde(default)]
+    pub ip6: String,
+    #[serde(default)]
+    pub family: String,
+    #[serde(default)]
+    pub mac: String,
+    #[serde(default)]
+    pub link: String,
+    #[serde(default)]
+    pub state: String,
 }
@@ -0,0 +1,110 @@
+#include "admission.h"
+
+#include <iostream>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+// Sources remembered at most, a flood of made up addresses can not grow the
+// table past this.
+constexpr size_t MAX_SOURCES = 4096;
+
+auto verdictName(Verdict verdict) -> const char * {
+	switch (verdict) {
+	case Verdict::ADMIT:
+		return "admit";
+	case Verdict::THROTTLED:
+		return "throttled";
+	case Verdict::OVERLOADED:
+		return "overloaded";
+	case Verdict::FULL:
+		return "full";
+	}
+	return "unknown";
+}
+
+Admission::Admission(const Timing &timing) { setLimits(timing); }
+
+void Admission::setLimits(const Timing &timing) {
+	m_rate = static_cast<double>(timing.announceRate);
+	m_burst = static_cast<double>(timing.announceBurst);
+	m_max_pending = static_cast<size_t>(timing.maxPendingPiers);
+	m_max_piers = static_cast<size_t>(timing.maxPiers);
+	m_max_source_piers = static_cast<size_t>(timing.maxPiersPerSource);
+	for (auto &source : m_buckets) {
+		source.second.tokens = std::min(source.second.tokens, m_burst);
+	}
+}
+
+void Admission::refill(Bucket &bucket,
+                       const time::steady_clock::time_point now) const {
+	const double elapsed_s =
+	    static_cast<double>(
+	        time::duration_cast<time::microseconds>(now - bucket.refilled)
+	            .count()) /
+	    1000000.0;
+	bucket.tokens = std::min(m_burst, bucket.tokens + elapsed_s * m_rate);
+	bucket.refilled = now;
+}
+
+void Admission::sweep(const time::steady_clock::time_point now) {
+	for (auto it = m_buckets.begin(); it != m_buckets.end();) {
+		refill(it->second, now);
+		if (it->second.tokens >= m_burst) {
+			it = m_buckets.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+auto Admission::admit(const std::string &source, const bool new_pier,
+                      const PierCounts &piers) -> Verdict {
+	Verdict verdict = Verdict::ADMIT;
+	Bucket *bucket = nullptr;
+	if (m_rate > 0) {
+		const auto now = time::steady_clock::now();
+		auto found = m_buckets.find(source);
+		if (found == m_buckets.end() && m_buckets.size() >= MAX_SOURCES) {
+			sweep(now);
+		}
+		if (found != m_buckets.end()) {
+			bucket = &found->second;
+			refill(*bucket, now);
+		} else if (m_buckets.size() < MAX_SOURCES) {
+			bucket = &m_buckets.emplace(source, Bucket{m_burst, now})
+			              .first->second;
+		}
+		// With the table full of sources still throttled a new one waits
+		// for room like a throttled one.
+		if (bucket == nullptr || bucket->tokens < 1) {
+			verdict = Verdict::THROTTLED;
+		}
+	}
+	if (verdict == Verdict::ADMIT && new_pier) {
+		if (piers.total >= m_max_piers ||
+		    piers.fromSource >= m_max_source_piers) {
+			verdict = Verdict::FULL;
+		} else if (piers.pending >= m_max_pending) {
+			verdict = Verdict::OVERLOADED;
+		}
+	}
+	if (verdict == Verdict::ADMIT) {
+		if (bucket != nullptr) {
+			bucket->tokens -= 1;
+			bucket->rejected = false;
+		}
+		return verdict;
+	}
+	// Under a flood logging every drop would cost more than the drop saves,
+	// sources without a bucket only show up in the stats.
+	if (bucket != nullptr && !bucket->rejected) {
+		cout << "AH Client: Dropping announcements from " << source << " ("
+		     << verdictName(verdict) << ")" << endl;
+		bucket->rejected = true;
+	}
+	return verdict;
+}
+} // namespace ahnd
@@ -0,0 +1,65 @@
+#ifndef AHND_ADMISSION_H
+#define AHND_ADMISSION_H
+
+#include "config.h"
+
+#include <unordered_map>
+
+namespace ahnd {
+
+enum class Verdict {
+	ADMIT,
+	THROTTLED,  // The source used up its token bucket.
+	OVERLOADED, // Too many piers are already being set up.
+	FULL        // No room for another pier, in all or from this source.
+};
+
+// The piers a new one would join.
+struct PierCounts {
+	// Still waiting for their face and route.
+	size_t pending{0};
+	size_t total{0};
+	// Announced from the same address.
+	size_t fromSource{0};
+};
+
+// Decides whether an announcement is handled at all, before anything is
+// signed or asked of NFD.  Each source address gets a token bucket so a
+// noisy node only throttles itself, and new piers are refused while too
+// many others wait for their face and route, or when the table (or the
+// source's share of it) is full.  The address is the one the announcement
+// carries, a source spoofing many addresses is held back by the pending and
+// total caps.
+class Admission {
+  private:
+	struct Bucket {
+		double tokens;
+		ndn::time::steady_clock::time_point refilled;
+		// Rejected since it was last admitted, only the first is logged.
+		bool rejected{false};
+	};
+	std::unordered_map<std::string, Bucket> m_buckets;
+	double m_rate{0};
+	double m_burst{0};
+	size_t m_max_pending{0};
+	size_t m_max_piers{0};
+	size_t m_max_source_piers{0};
+
+	void refill(Bucket &bucket, ndn::time::steady_clock::time_point now) const;
+	// Drop buckets that are full again, their sources are as good as new.
+	void sweep(ndn::time::steady_clock::time_point now);
+
+  public:
+	explicit Admission(const Timing &timing);
+	void setLimits(const Timing &timing);
+	// An announcement from source (an address), new_pier if it would add a
+	// pier to those counted in piers.
+	auto admit(const std::string &source, bool new_pier,
+	           const PierCounts &piers) -> Verdict;
+	auto sources() const -> size_t { return m_buckets.size(); }
+};
+
+auto verdictName(Verdict verdict) -> const char *;
+} // namespace ahnd
+
+#endif // AHND_ADMISSION_H
@@ -1,28 +1,102 @@
 #include "ahclient.h"
+#include "admission.h"
+#include "ahnd-tlv.h"
+#include "bench.h"
+#include "bloomfilter.h"
+#include "datatemplate.h"
+#include "election.h"
+#include "loadstats.h"
+#include "multicast.h"
+#include "netlink.h"
 #include "nfd-command-tlv.h"
+#include "pierlist.h"
+#include "pinger.h"
+#include "retrypolicy.h"
+#include "statusinfo.h"
+#include "tracer.h"
+#include "workerpool.h"
 
 #include <arpa/inet.h>
+#include <fstream>
+#include <net/if_arp.h>
 #include <ifaddrs.h>
 #include <iostream>
+#include <net/if.h>
+#include <ndn-cxx/util/random.hpp>
 #include <netdb.h>
+#include <set>
+#include <unistd.h>
 
 using namespace ndn;
 using namespace std;
 
-constexpr ndn::time::milliseconds SERVER_DISCOVERY_INTEREST_LIFETIME = 4_s;
 constexpr int BUF_SIZE = 1000;
-constexpr int FRESHNESS_MS = 4000;
-constexpr auto INTEREST_LIFETIME = 30_s;
+// Arbitrary size.
+constexpr size_t PING_PAYLOAD_SIZE = 5;
+// Bounds on what a ping can ask for (a payload that fits one UDP packet) and
+// on the measurements the agent will run.
+constexpr size_t MAX_PING_PAYLOAD = 8000;
+constexpr size_t MAX_PING_TEMPLATES = 16;
+constexpr long MAX_PING_COUNT = 10000;
+// Expected number of members that ack a multicast arrival.
+constexpr double ARRIVAL_ACKS = 2.0;
+// New piers' announcements remembered while others are being set up.
+constexpr size_t MAX_DEFERRED = 256;
+// Limit the routes a single announcement can make us register.
+constexpr size_t MAX_EXTRA_PREFIXES = 32;
+// Piers pulled from per gossip round and how far gossiped routes travel.
+constexpr size_t GOSSIP_FANOUT = 3;
+constexpr uint64_t GOSSIP_MAX_HOPS = 4;
+// Bound the pier list a single pier can make us hold, over all its pages.
+constexpr size_t MAX_GOSSIP_ENTRIES = 16384;
+// What a gossip reply holds besides its name and content: MetaInfo,
+// SignatureInfo, a DigestSha256 SignatureValue and the TLV headers.
+constexpr size_t GOSSIP_DATA_OVERHEAD = 128;
+// Keepalive periods (each re-announces everyone) a delegate candidate may
+// go unheard before it is dropped from the election.
+constexpr long ELECTION_EXPIRY_ROUNDS = 3;
+// Route cost added per hop beyond a direct pier.
+constexpr int ROUTE_HOP_COST = 10;
+// Direct route cost is the smoothed RTT in milliseconds, inflated by the loss
+// rate.  It is only re-registered when it moves by more than
+// COST_HYSTERESIS (fraction) and COST_HYSTERESIS_MIN.
+constexpr double RTT_GAIN = 0.125;
+constexpr double LOSS_GAIN = 0.125;
+constexpr double LOSS_COST_FACTOR = 4.0;
+constexpr double COST_HYSTERESIS = 0.25;
+constexpr int COST_HYSTERESIS_MIN = 2;
+constexpr int MAX_ROUTE_COST = 10000;
+// Happy eyeballs between the IPv4 and IPv6 faces of a pier: probes per
+// family, their spacing and lifetime, how long to let the probe routes
+// register first and how much faster the other family has to be to switch.
+constexpr int RACE_PROBES = 3;
+constexpr long RACE_PROBE_SPACING_MS = 100;
+constexpr auto RACE_PROBE_LIFETIME = 1_s;
+constexpr long RACE_SETTLE_MS = 500;
+constexpr double RACE_MARGIN = 0.9;
+// Loss rate that turns LP reliability on for a pier's face, it is turned off
+// again below half of it.
+constexpr double LOSSY_LOSS_RATE = 0.05;
+// Give the nd-info exchange time to resolve a pier's MAC before looking it
+// up for an Ethernet face.
+constexpr long ETHER_LOOKUP_SECONDS = 2;
+// Wait for a burst of netlink events to settle before rescanning.
+constexpr long INTERFACE_SETTLE_MS = 200;
+constexpr long REANNOUNCE_SECONDS = 2;
+// Interface rank when the driver does not report a link speed.
+constexpr long DEFAULT_WIRELESS_MBPS = 54;
+constexpr long DEFAULT_WIRED_MBPS = 100;
 
 static auto makeRibInterestParameter(const ndn::Name &route_name,
-                                     const int face_id) -> ndn::Block {
+                                     const int face_id, const int cost)
+    -> ndn::Block {
 	auto block = ndn::makeEmptyBlock(CONTROL_PARAMETERS);
 	const ndn::Block &route_name_block = route_name.wireEncode();
 	ndn::Block face_id_block =
 	    ndn::makeNonNegativeIntegerBlock(FACE_ID, face_id);
 	// NOLINTNEXTLINE(cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
 	ndn::Block origin_block = ndn::makeNonNegativeIntegerBlock(ORIGIN, 0xFF);
-	ndn::Block cost_block = ndn::makeNonNegativeIntegerBlock(COST, 0);
+	ndn::Block cost_block = ndn::makeNonNegativeIntegerBlock(COST, cost);
 	ndn::Block flags_block = ndn::makeNonNegativeIntegerBlock(FLAGS, 0x01);
 
 	block.push_back(route_name_block);
@@ -65,10 +139,11 @@ static auto makeRibUnregisterInterestParameter(const ndn::Name &route_name,
 }
 
 static auto prepareRibRegisterInterest(const ndn::Name &route_name, int face_id,
-                                       ndn::KeyChain &keychain)
+                                       int cost, ndn::KeyChain &keychain)
     -> ndn::Interest {
 	ndn::Name name("/localhost/nfd/rib/register");
-	ndn::Block control_params = makeRibInterestParameter(route_name, face_id);
+	ndn::Block control_params =
+	    makeRibInterestParameter(route_name, face_id, cost);
 	name.append(control_params);
 
 	ndn::security::CommandInterestSigner signer(keychain);
@@ -93,12 +168,19 @@ static auto prepareRibUnregisterInterest(const ndn::Name &route_name,
 	return interest;
 }
 
+// Unicast Ethernet faces also need the interface as the local URI.
 static auto prepareFaceCreationInterest(const std::string &uri,
+                                        const std::string &local_uri,
+                                        const ahnd::FaceProfile &profile,
                                         ndn::KeyChain &keychain)
     -> ndn::Interest {
 	ndn::Name name("/localhost/nfd/faces/create");
 	auto control_block = ndn::makeEmptyBlock(CONTROL_PARAMETERS);
 	control_block.push_back(ndn::makeStringBlock(URI, uri));
+	if (!local_uri.empty()) {
+		control_block.push_back(ndn::makeStringBlock(LOCAL_URI, local_uri));
+	}
+	profile.addTo(control_block);
 	control_block.encode();
 	name.append(control_block);
 
@@ -124,27 +206,231 @@ static auto prepareFaceDestroyInterest(int face_id, ndn::KeyChain &keychain)
 	return interest;
 }
 
+static auto prepareFaceUpdateInterest(int face_id,
+                                      const ahnd::FaceProfile &profile,
+                                      ndn::KeyChain &keychain)
+    -> ndn::Interest {
+	ndn::Name name("/localhost/nfd/faces/update");
+	auto control_block = ndn::makeEmptyBlock(CONTROL_PARAMETERS);
+	control_block.push_back(ndn::makeNonNegativeIntegerBlock(FACE_ID, face_id));
+	profile.addTo(control_block);
+	control_block.encode();
+	name.append(control_block);
+
+	ndn::security::CommandInterestSigner signer(keychain);
+	ndn::Interest interest = signer.makeCommandInterest(name);
+	interest.setMustBeFresh(true);
+	interest.setCanBePrefix(false);
+	return interest;
+}
+
+// MAC address of a resolved neighbor on dev from the kernel ARP table, empty
+// if there is none.
+static auto arpLookup(const in_addr &ip, const std::string &dev)
+    -> std::string {
+	std::ifstream arp("/proc/net/arp");
+	std::string line;
+	// Skip the header.
+	std::getline(arp, line);
+	const std::string ip_str(inet_ntoa(ip));
+	while (std::getline(arp, line)) {
+		std::istringstream fields(line);
+		std::string addr;
+		std::string hw_type;
+		std::string flags;
+		std::string mac;
+		std::string mask;
+		std::string arp_dev;
+		if (!(fields >> addr >> hw_type >> flags >> mac >> mask >> arp_dev)) {
+			continue;
+		}
+		if (addr == ip_str && arp_dev == dev &&
+		    (std::stoul(flags, nullptr, 16) & ATF_COM) != 0) {
+			return mac;
+		}
+	}
+	return "";
+}
+
+// Face id from a faces/create response, 0 if the face was not created.
+static auto faceIdFromResponse(const ndn::Data &data) -> int {
+	const ndn::Block &response = data.getContent().blockFromValue();
+	response.parse();
+	const int code = readNonNegativeIntegerAs<int>(response.get(STATUS_CODE));
+	if (code != OK && code != FACE_EXISTS) {
+		return 0;
+	}
+	const ndn::Block &params = response.get(CONTROL_PARAMETERS);
+	params.parse();
+	return readNonNegativeIntegerAs<int>(params.get(FACE_ID));
+}
+
+static auto udpUri(const in_addr &ip, uint16_t port) -> std::string {
+	std::stringstream ss;
+	ss << "udp4://" << inet_ntoa(ip) << ':' << ntohs(port);
+	return ss.str();
+}
+
+static auto ip6String(const in6_addr &ip) -> std::string {
+	std::array<char, INET6_ADDRSTRLEN> buf{0};
+	inet_ntop(AF_INET6, &ip, buf.data(), buf.size());
+	return buf.data();
+}
+
+static auto sameSubnet(const in6_addr &a, const in6_addr &b,
+                       const in6_addr &netmask) -> bool {
+	for (size_t i = 0; i < sizeof(netmask.s6_addr); i++) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+		const uint8_t mask = netmask.s6_addr[i];
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+		if ((a.s6_addr[i] & mask) != (b.s6_addr[i] & mask)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static auto udpUri(const in6_addr &ip, uint16_t port) -> std::string {
+	std::stringstream ss;
+	ss << "udp6://[" << ip6String(ip) << "]:" << ntohs(port);
+	return ss.str();
+}
+
+// Keepalive names routed only to one family's face of a pier.
+static auto probeName(const ndn::Name &prefix, bool ip6) -> ndn::Name {
+	ndn::Name name(prefix);
+	name.append("nd-keepalive").append(ip6 ? "udp6" : "udp4");
+	return name;
+}
+
+static auto isProbeName(const ndn::Name &name) -> bool {
+	return name.size() >= 2 &&
+	       name.get(-2) == ndn::name::Component("nd-keepalive");
+}
+
 namespace ahnd {
 
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 long DBEntry::count = 0;
 
-AHClient::AHClient(Name prefix, Name broadcast_prefix, int port)
-    : m_prefix(std::move(prefix)),
-      m_broadcast_prefix(std::move(broadcast_prefix)) {
+void DBEntry::clear() {
+	ip.s_addr = 0;
+	ip6 = in6_addr{};
+	hasIp6 = false;
+	useIp6 = false;
+	port = 0;
+	mac.clear();
+	prefix.clear();
+	extraPrefixes.clear();
+	faceId = 0;
+	srttMs = 0;
+	lossRate = 0;
+	rttSamples = 0;
+	cost = 0;
+	link = LinkClass::LAN;
+	lossy = false;
+	raceFaceId = 0;
+	raceProbes = 0;
+	race4Ms = 0;
+	race6Ms = 0;
+	state = PierState::DISCOVERED;
+	infoPending = false;
+	infoWanted = false;
+	discovered = ndn::time::steady_clock::time_point();
+	heard = ndn::time::steady_clock::time_point();
+	countersFaceId = 0;
+	faceInInterests = 0;
+	faceInData = 0;
+	track = 0;
+}
+
+auto pierStateName(const PierState state) -> const char * {
+	switch (state) {
+	case PierState::DISCOVERED:
+		return "discovered";
+	case PierState::FACE_PENDING:
+		return "face-pending";
+	case PierState::ROUTE_PENDING:
+		return "route-pending";
+	case PierState::CONFIRMED:
+		return "confirmed";
+	case PierState::SUSPECT:
+		return "suspect";
+	case PierState::TEARING_DOWN:
+		return "tearing-down";
+	}
+	return "unknown";
+}
+
+struct AHClient::Replies {
+	DataTemplate ack;
+	DataTemplate ping;
+	// Pings that asked for another payload size.
+	std::map<size_t, DataTemplate> pings;
+	// Never fresh, a benchmark must not be answered from a cache.
+	DataTemplate benchSegment;
+
+	explicit Replies(time::milliseconds freshness)
+	    : ack(freshness, Buffer()),
+	      ping(freshness, Buffer(PING_PAYLOAD_SIZE, 'a')),
+	      benchSegment(time::milliseconds(0), Buffer(BENCH_SEGMENT_SIZE, 'b')) {
+	}
+};
+
+AHClient::AHClient(Name prefix, Name broadcast_prefix, int port,
+                   const Timing &timing)
+    : AHClient(make_unique<Face>(), nullptr, std::move(prefix),
+               std::move(broadcast_prefix), port, timing) {}
+
+AHClient::AHClient(Face &face, Name prefix, Name broadcast_prefix, int port,
+                   const Timing &timing)
+    : AHClient(nullptr, &face, std::move(prefix), std::move(broadcast_prefix),
+               port, timing) {}
+
+AHClient::AHClient(unique_ptr<Face> owned_face, Face *face, Name prefix,
+                   Name broadcast_prefix, int port, const Timing &timing)
+    : m_owned_face(std::move(owned_face)),
+      m_face(face != nullptr ? *face : *m_owned_face),
+      m_stats(make_unique<LoadStats>()), m_tracer(make_unique<Tracer>()),
+      m_timing(timing), m_admission(make_unique<Admission>(timing)),
+      m_replies(make_unique<Replies>(time::milliseconds(timing.freshnessMs))),
+      m_prefix(std::move(prefix)),
+      m_broadcast_prefix(std::move(broadcast_prefix)),
+      m_gossip_version(static_cast<uint64_t>(
+          time::toUnixTimestamp(time::system_clock::now()).count())) {
 	m_scheduler = make_unique<Scheduler>(m_face.getIoService());
+	m_retry = make_unique<RetryPolicy>(
+	    *m_scheduler, static_cast<size_t>(m_timing.retryBudget));
 	m_controller = std::make_shared<nfd::Controller>(m_face, m_keyChain);
 	setIP();
 	m_port = htons(port);
-	m_multicast = std::make_unique<MulticastInterest>(m_face, m_controller,
-	                                                  m_broadcast_prefix);
-	m_statusinfo = std::make_unique<StatusInfo>(m_controller);
+	for (auto link : {LinkClass::ETHER, LinkClass::LAN, LinkClass::WIRELESS,
+	                  LinkClass::WAN}) {
+		m_face_profiles[link] = defaultFaceProfile(link);
+	}
+	// Only our own face gets local fields unasked, see setLocalFields().
+	m_multicast = std::make_unique<MulticastInterest>(
+	    m_face, m_controller, m_broadcast_prefix, m_owned_face != nullptr);
+	m_workers = std::make_unique<WorkerPool>(m_face.getIoService());
+	m_statusinfo = std::make_unique<StatusInfo>(m_controller, *m_workers);
+	m_netlink = std::make_unique<NetlinkMonitor>(
+	    m_face.getIoService(), [this] { scheduleInterfaceRefresh(); });
 }
 
-void AHClient::appendIpPort(Name &name) {
-	// This does some unsafe C casting.
+void AHClient::appendIpPort(Name &name) { appendIpPort(name, m_IP); }
+
+void AHClient::appendIpPort(Name &name, const in_addr &ip) {
+	// This does some unsafe C casting.  Receivers tell the families apart by
+	// the component size.
+	if (ip.s_addr == 0 && m_has_ip6) {
+		// NOLINTNEXTLINE: unsafe C style cast
+		name.append((uint8_t *)&m_IP6, sizeof(m_IP6));
+	} else {
+		// NOLINTNEXTLINE: unsafe C style cast
+		name.append((uint8_t *)&ip, sizeof(ip));
+	}
 	// NOLINTNEXTLINE: unsafe C style cast
-	name.append((uint8_t *)&m_IP, sizeof(m_IP))
+	name
 	    // NOLINTNEXTLINE: unsafe C style cast
 	    .append((uint8_t *)&m_port, sizeof(m_port));
 }
@@ -154,12 +440,109 @@ auto AHClient::newItem() -> DBEntry & {
 	if (!m_db_free.empty()) {
 		idx = m_db_free.back();
 		m_db_free.pop_back();
+		m_db.at(idx).clear();
 	} else {
 		idx = m_db.size();
 		DBEntry e;
 		m_db.push_back(e);
 	}
-	return m_db.at(idx);
+	DBEntry &entry = m_db.at(idx);
+	entry.track = m_next_track++;
+	return entry;
+}
+
+auto AHClient::pierCount() -> size_t {
+	size_t count = 0;
+	for (const auto &item : m_db) {
+		if (!item.prefix.empty()) {
+			count++;
+		}
+	}
+	return count;
+}
+
+auto AHClient::provisioningCount() -> size_t {
+	size_t count = 0;
+	for (const auto &item : m_db) {
+		if (!item.prefix.empty() && (item.state == PierState::DISCOVERED ||
+		                             item.state == PierState::FACE_PENDING ||
+		                             item.state == PierState::ROUTE_PENDING)) {
+			count++;
+		}
+	}
+	return count;
+}
+
+auto AHClient::pierCounts(const in_addr &ip, const in6_addr &ip6,
+                          const bool use_ip6) -> PierCounts {
+	PierCounts counts;
+	for (const auto &item : m_db) {
+		if (item.prefix.empty()) {
+			continue;
+		}
+		counts.total++;
+		if (item.state == PierState::DISCOVERED ||
+		    item.state == PierState::FACE_PENDING ||
+		    item.state == PierState::ROUTE_PENDING) {
+			counts.pending++;
+		}
+		if (use_ip6 ? item.hasIp6 &&
+		                  memcmp(&item.ip6, &ip6, sizeof(ip6)) == 0
+		            : item.ip.s_addr == ip.s_addr) {
+			counts.fromSource++;
+		}
+	}
+	return counts;
+}
+
+void AHClient::deferAnnouncement(const Interest &request, const bool send_back,
+                                 const Name &prefix) {
+	const auto now = time::steady_clock::now();
+	for (auto &deferred : m_deferred) {
+		if (deferred.prefix.equals(prefix)) {
+			// Keeps its place in line with its latest announcement.
+			deferred = {request, send_back, prefix, now};
+			return;
+		}
+	}
+	if (m_deferred.size() >= MAX_DEFERRED) {
+		m_deferred.pop_front();
+	}
+	m_deferred.push_back({request, send_back, prefix, now});
+}
+
+void AHClient::readmitDeferred() {
+	if (m_deferred.empty()) {
+		return;
+	}
+	// Not from inside the caller, handling an announcement adds entries.
+	m_readmit = m_scheduler->schedule(time::milliseconds(0), [this] {
+		// Piers announce themselves every keepalive period, anything older
+		// has been superseded or is gone.
+		const auto oldest = time::steady_clock::now() -
+		                    time::seconds(m_timing.keepaliveSeconds);
+		while (!m_deferred.empty() &&
+		       provisioningCount() <
+		           static_cast<size_t>(m_timing.maxPendingPiers)) {
+			const DeferredAnnouncement deferred = m_deferred.front();
+			m_deferred.pop_front();
+			if (deferred.received < oldest || hasEntry(deferred.prefix)) {
+				continue;
+			}
+			cout << "AH Client: Admitting deferred " << deferred.prefix
+			     << endl;
+			onArriveInterest(deferred.request, deferred.sendBack);
+		}
+	});
+}
+
+auto AHClient::findItem(const Name &name) -> DBEntry * {
+	for (auto &item : m_db) {
+		if (!item.prefix.empty() && item.prefix.equals(name)) {
+			return &item;
+		}
+	}
+	return nullptr;
 }
 
 auto AHClient::hasEntry(const Name &name) -> bool {
@@ -178,6 +561,8 @@ void AHClient::removeItem(const Name &name) {
 		if (it->prefix.equals(name)) {
 			cout << "AH Client: Removing by prefix " << it->id << ": "
 			     << it->prefix << " from DB" << endl;
+			// Cancels whatever is still pending for the pier.
+			m_pier_ops.erase(it->prefix);
 			it->prefix.clear();
 			m_db_free.push_back(i);
 			break;
@@ -193,6 +578,12 @@ void AHClient::removeItem(const DBEntry &item) {
 		if (it->id == item.id) {
 			cout << "AH Client: Removing by item " << it->id << ": "
 			     << it->prefix << " from DB" << endl;
+			if (it->raceFaceId > 0) {
+				destroyFace(it->raceFaceId);
+				it->raceFaceId = 0;
+			}
+			// Cancels whatever is still pending for the pier.
+			m_pier_ops.erase(it->prefix);
 			it->prefix.clear();
 			m_db_free.push_back(i);
 			break;
@@ -202,10 +593,59 @@ void AHClient::removeItem(const DBEntry &item) {
 	}
 }
 
+void AHClient::setAnnouncementParameters(Interest &interest,
+                                         const bool with_digest) {
+	auto params = makeEmptyBlock(tlv::ApplicationParameters);
+	for (const auto &extra : m_extra_prefixes) {
+		params.push_back(extra.wireEncode());
+	}
+	if (m_has_ip6 && m_IP.s_addr != 0) {
+		// The name carries our IPv4 address, offer IPv6 as well.
+		params.push_back(makeBinaryBlock(ADDRESS_V6, m_IP6.s6_addr,
+		                                 sizeof(m_IP6.s6_addr)));
+	}
+	const size_t piers = pierCount();
+	// With no piers there is nothing to summarize, everyone should answer.
+	if (with_digest && piers > 0) {
+		BloomFilter digest(piers, random::generateWord32());
+		for (const auto &item : m_db) {
+			if (!item.prefix.empty()) {
+				digest.insert(item.prefix);
+			}
+		}
+		params.push_back(digest.wireEncode());
+	}
+	if (params.elements().empty()) {
+		return;
+	}
+	params.encode();
+	interest.setApplicationParameters(params);
+}
+
+void AHClient::addPrefix(const Name &prefix) {
+	if (!prefix.equals(m_prefix) &&
+	    std::find(m_extra_prefixes.begin(), m_extra_prefixes.end(), prefix) ==
+	        m_extra_prefixes.end()) {
+		m_extra_prefixes.push_back(prefix);
+	}
+}
+
 void AHClient::processEvents(long timeout_ms) {
 	m_face.processEvents(time::milliseconds(timeout_ms));
 }
 
+void AHClient::setTiming(const Timing &timing) {
+	if (timing.freshnessMs != m_timing.freshnessMs) {
+		m_replies =
+		    make_unique<Replies>(time::milliseconds(timing.freshnessMs));
+	}
+	m_retry->setBudget(static_cast<size_t>(timing.retryBudget));
+	m_admission->setLimits(timing);
+	m_timing = timing;
+}
+
+AHClient::~AHClient() = default;
+
 void AHClient::shutdown() {
 	cout << "AH Client: Shutting down" << endl;
 	sendDepartureInterest();
@@ -218,17 +658,21 @@ void AHClient::shutdown() {
 		}
 		auto prefix = item.prefix;
 		auto face_id = item.faceId;
+		if (m_events.pierDown && (item.state == PierState::CONFIRMED ||
+		                          item.state == PierState::SUSPECT)) {
+			m_events.pierDown(item);
+		}
 		removeItem(item);
 		removeRouteAndFace(prefix, face_id);
 		++it;
 	}
 }
 
-void AHClient::registerClientPrefix() {
+void AHClient::registerClientPrefix(int attempt) {
 	Name name(m_prefix);
 	name.append("nd-info");
 	cout << "AH Client: Registering Client Prefix: " << name << endl;
-	m_face.setInterestFilter(
+	m_prefix_handles[name] = m_face.setInterestFilter(
 	    InterestFilter(name),
 	    [this](auto &&_, auto &&PH2) { onArriveInterest(PH2, false); },
 	    [this](const Name &name) {
@@ -237,28 +681,30 @@ void AHClient::registerClientPrefix() {
 		    // Now register keep alive prefix.
 		    registerKeepAlivePrefix();
 	    },
-	    [this](const Name &name, const std::string &error) {
+	    [this, attempt](const Name &name, const std::string &error) {
 		    std::cout << "AH Client: Failed to register client prefix "
 		              << name.toUri() << " reason: " << error << std::endl;
-		    m_scheduler->schedule(time::seconds(3),
-		                          [this] { registerClientPrefix(); });
+		    m_retry->schedule(RetryOp::PREFIX, attempt, [this, attempt] {
+			    registerClientPrefix(attempt + 1);
+		    });
 	    });
 }
 
-void AHClient::registerKeepAlivePrefix() {
+void AHClient::registerKeepAlivePrefix(int attempt) {
 	Name name(m_prefix);
 	name.append("nd-keepalive");
 	cout << "AH Client: Registering KeepAlive Prefix: " << name << endl;
-	m_face.setInterestFilter(
+	m_prefix_handles[name] = m_face.setInterestFilter(
 	    InterestFilter(name),
 	    [this](const InterestFilter &filter, const Interest &request) {
 		    cout << "AH Client: Received a keep alive, responding." << endl;
-		    auto data = make_shared<Data>(request.getName());
-		    m_keyChain.sign(*data,
-		                    security::SigningInfo(
-		                        security::SigningInfo::SIGNER_TYPE_SHA256));
-		    data->setFreshnessPeriod(time::milliseconds(FRESHNESS_MS));
-		    m_face.put(*data);
+		    m_face.put(m_replies->ack.make(request.getName()));
+		    // NFD tells us the face it came in on while local fields are
+		    // enabled, that is the pier's unicast face.
+		    auto incoming = request.getTag<lp::IncomingFaceIdTag>();
+		    if (incoming != nullptr) {
+			    heardOn(incoming->get());
+		    }
 	    },
 	    [this](const Name &name) {
 		    std::cout << "AH Client: Registered client prefix " << name.toUri()
@@ -266,34 +712,33 @@ void AHClient::registerKeepAlivePrefix() {
 		    // Now register broadcast prefix.
 		    registerPingPrefix();
 	    },
-	    [this](const Name &name, const std::string &error) {
+	    [this, attempt](const Name &name, const std::string &error) {
 		    std::cout << "AH Client: Failed to register client prefix "
 		              << name.toUri() << " reason: " << error << std::endl;
-		    m_scheduler->schedule(time::seconds(3),
-		                          [this] { registerKeepAlivePrefix(); });
+		    m_retry->schedule(RetryOp::PREFIX, attempt, [this, attempt] {
+			    registerKeepAlivePrefix(attempt + 1);
+		    });
 	    });
 }
 
-void AHClient::registerPingPrefix() {
+void AHClient::registerPingPrefix(int attempt) {
 	Name name(m_prefix);
 	name.append("ping");
 	cout << "AH Client: Registering Ping Prefix: " << name << endl;
-	m_face.setInterestFilter(
+	m_prefix_handles[name] = m_face.setInterestFilter(
 	    InterestFilter(name),
 	    [this](const InterestFilter &filter, const Interest &request) {
-		    cout << "AH Client: Received a ping, responding." << endl;
-		    auto data = make_shared<Data>(request.getName());
-		    data->setFreshnessPeriod(time::milliseconds(FRESHNESS_MS));
-		    auto b = make_shared<Buffer>();
-		    auto const payload_size = 5; // Arbitrary size.
-		    b->assign(payload_size, 'a');
-		    auto payload = Block(tlv::Content, std::move(b));
-		    data->setContent(payload);
-		    m_keyChain.sign(*data,
-		                    security::SigningInfo(
-		                        security::SigningInfo::SIGNER_TYPE_SHA256));
-		    data->setFreshnessPeriod(time::milliseconds(FRESHNESS_MS));
-		    m_face.put(*data);
+		    // Name: /<prefix>/ping[/payload/<size>]/...
+		    const Name &name = request.getName();
+		    const size_t at = filter.getPrefix().size();
+		    size_t payload_size = PING_PAYLOAD_SIZE;
+		    if (name.size() > at + 1 &&
+		        name.at(at) == Name::Component("payload") &&
+		        name.at(at + 1).isNumber()) {
+			    payload_size = std::min<size_t>(name.at(at + 1).toNumber(),
+			                                    MAX_PING_PAYLOAD);
+		    }
+		    m_face.put(pingReply(payload_size).make(name));
 	    },
 	    [this](const Name &name) {
 		    std::cout << "AH Client: Registered client ping prefix "
@@ -301,33 +746,55 @@ void AHClient::registerPingPrefix() {
 		    // Now register broadcast prefix.
 		    registerStatusPrefix();
 	    },
-	    [this](const Name &name, const std::string &error) {
+	    [this, attempt](const Name &name, const std::string &error) {
 		    std::cout << "AH Client: Failed to register client ping prefix "
 		              << name.toUri() << " reason: " << error << std::endl;
-		    m_scheduler->schedule(time::seconds(3),
-		                          [this] { registerPingPrefix(); });
+		    m_retry->schedule(RetryOp::PREFIX, attempt, [this, attempt] {
+			    registerPingPrefix(attempt + 1);
+		    });
 	    });
 }
 
-void AHClient::registerStatusPrefix() {
+auto AHClient::pingReply(const size_t payload_size) -> const DataTemplate & {
+	if (payload_size == PING_PAYLOAD_SIZE) {
+		return m_replies->ping;
+	}
+	auto reply = m_replies->pings.find(payload_size);
+	if (reply == m_replies->pings.end()) {
+		if (m_replies->pings.size() >= MAX_PING_TEMPLATES) {
+			m_replies->pings.clear();
+		}
+		const auto freshness = time::milliseconds(m_timing.freshnessMs);
+		reply = m_replies->pings
+		            .emplace(payload_size,
+		                     DataTemplate(freshness, Buffer(payload_size, 'a')))
+		            .first;
+	}
+	return reply->second;
+}
+
+void AHClient::registerStatusPrefix(int attempt) {
 	Name name(m_prefix);
 	name.append("nd-status");
 	cout << "AH Client: Registering KeepAlive Prefix: " << name << endl;
-	m_face.setInterestFilter(
+	m_prefix_handles[name] = m_face.setInterestFilter(
 	    InterestFilter(name),
 	    [this](const InterestFilter &filter, const Interest &request) {
 		    cout << "AH Client: Received status request, responding." << endl;
 		    m_statusinfo->getStatus(
-		        [this, request](const string &json) {
-			        auto data = make_shared<Data>(request.getName());
-			        auto b = make_shared<Buffer>(json.begin(), json.end());
-			        auto payload = Block(tlv::Content, std::move(b));
-			        data->setContent(payload);
-			        m_keyChain.sign(
-			            *data, security::SigningInfo(
-			                       security::SigningInfo::SIGNER_TYPE_SHA256));
-			        data->setFreshnessPeriod(time::milliseconds(FRESHNESS_MS));
-			        m_face.put(*data);
+		        [this, name = request.getName()](const string &json) {
+			        // Encoding and hashing a large document is left to a
+			        // worker as well.
+			        auto data = make_shared<Data>();
+			        m_workers->submit(
+			            [data, name, json, freshness = m_timing.freshnessMs] {
+				            const Buffer content(json.begin(), json.end());
+				            *data = DataTemplate(
+				                        time::milliseconds(freshness),
+				                        content)
+				                        .make(name);
+			            },
+			            [this, data] { m_face.put(*data); });
 		        },
 		        [](const string &reason) {
 			        std::cout
@@ -338,20 +805,93 @@ void AHClient::registerStatusPrefix() {
 	    [this](const Name &name) {
 		    std::cout << "AH Client: Registered client status prefix "
 		              << name.toUri() << std::endl;
-		    registerArrivePrefix();
+		    registerGossipPrefix();
 	    },
-	    [this](const Name &name, const std::string &error) {
+	    [this, attempt](const Name &name, const std::string &error) {
 		    std::cout << "AH Client: Failed to register client status prefix "
 		              << name.toUri() << " reason: " << error << std::endl;
-		    m_scheduler->schedule(time::seconds(3),
-		                          [this] { registerStatusPrefix(); });
+		    m_retry->schedule(RetryOp::PREFIX, attempt, [this, attempt] {
+			    registerStatusPrefix(attempt + 1);
+		    });
+	    });
+}
+
+void AHClient::registerGossipPrefix(int attempt) {
+	Name name(m_prefix);
+	name.append("nd-gossip");
+	cout << "AH Client: Registering Gossip Prefix: " << name << endl;
+	m_prefix_handles[name] = m_face.setInterestFilter(
+	    InterestFilter(name),
+	    [this](auto &&_, auto &&PH2) { onGossipInterest(PH2); },
+	    [this](const Name &name) {
+		    std::cout << "AH Client: Registered client gossip prefix "
+		              << name.toUri() << std::endl;
+		    registerBenchPrefix();
+	    },
+	    [this, attempt](const Name &name, const std::string &error) {
+		    std::cout << "AH Client: Failed to register client gossip prefix "
+		              << name.toUri() << " reason: " << error << std::endl;
+		    m_retry->schedule(RetryOp::PREFIX, attempt, [this, attempt] {
+			    registerGossipPrefix(attempt + 1);
+		    });
+	    });
+}
+
+void AHClient::registerBenchPrefix(int attempt) {
+	Name name(m_prefix);
+	name.append("nd-bench");
+	cout << "AH Client: Registering Bench Prefix: " << name << endl;
+	m_prefix_handles[name] = m_face.setInterestFilter(
+	    InterestFilter(name),
+	    [this](auto &&_, auto &&PH2) { onBenchInterest(PH2); },
+	    [this](const Name &name) {
+		    std::cout << "AH Client: Registered client bench prefix "
+		              << name.toUri() << std::endl;
+		    registerArrivePrefix();
+	    },
+	    [this, attempt](const Name &name, const std::string &error) {
+		    std::cout << "AH Client: Failed to register client bench prefix "
+		              << name.toUri() << " reason: " << error << std::endl;
+		    m_retry->schedule(RetryOp::PREFIX, attempt, [this, attempt] {
+			    registerBenchPrefix(attempt + 1);
+		    });
 	    });
 }
 
-void AHClient::registerArrivePrefix() {
+void AHClient::onBenchInterest(const Interest &request) {
+	// Name: /<prefix>/nd-bench/<size>/<seg>, this is the hot path of a
+	// benchmark so no logging.
+	const Name &name = request.getName();
+	const size_t at = m_prefix.size() + 1;
+	if (name.size() < at + 2 || !name.at(at).isNumber() ||
+	    !name.at(at + 1).isSegment()) {
+		return;
+	}
+	const uint64_t size = name.at(at).toNumber();
+	const uint64_t seg = name.at(at + 1).toSegment();
+	const uint64_t segments =
+	    (size + BENCH_SEGMENT_SIZE - 1) / BENCH_SEGMENT_SIZE;
+	if (size > MAX_BENCH_BYTES || seg >= segments) {
+		return;
+	}
+	if (seg + 1 < segments) {
+		m_face.put(m_replies->benchSegment.make(name));
+		return;
+	}
+	// The last segment is short and carries the FinalBlockId.
+	auto data = make_shared<Data>(name);
+	const Buffer content(size - seg * BENCH_SEGMENT_SIZE, 'b');
+	data->setContent(content.data(), content.size());
+	data->setFinalBlock(name.at(at + 1));
+	m_keyChain.sign(*data, security::SigningInfo(
+	                           security::SigningInfo::SIGNER_TYPE_SHA256));
+	m_face.put(*data);
+}
+
+void AHClient::registerArrivePrefix(int attempt) {
 	std::cout << "AH Client: Registering arrive prefix "
 	          << m_broadcast_prefix.toUri() << std::endl;
-	m_arrivePrefixId = m_face.setInterestFilter(
+	m_prefix_handles[m_broadcast_prefix] = m_face.setInterestFilter(
 	    InterestFilter(m_broadcast_prefix),
 	    [this](auto &&_, auto &&PH2) { onArriveInterest(PH2, true); },
 	    [this](const Name &name) {
@@ -360,60 +900,93 @@ void AHClient::registerArrivePrefix() {
 		    // Send our multicast arrive interest.
 		    sendArrivalInterest();
 	    },
-	    [this](const Name &name, const std::string &error) {
+	    [this, attempt](const Name &name, const std::string &error) {
 		    std::cout << "AH Client: Failed to register arrive prefix "
 		              << name.toUri() << " reason: " << error << std::endl;
-		    m_scheduler->schedule(time::seconds(3),
-		                          [this] { registerArrivePrefix(); });
+		    m_retry->schedule(RetryOp::PREFIX, attempt, [this, attempt] {
+			    registerArrivePrefix(attempt + 1);
+		    });
 	    });
 }
 
 void AHClient::sendArrivalInterestInternal() {
+	if (m_interfaces.empty()) {
+		// Netlink will trigger a new arrival when an address shows up.
+		cout << "AH Client: No usable address, not announcing" << endl;
+		return;
+	}
 	if (m_multicast->isError()) {
-		cout << "AH Client: Multicast error, exiting" << endl;
-		exit(1);
+		// Likely the multi-access faces went away with an interface, NFD will
+		// recreate them when it comes back.
+		cout << "AH Client: Multicast error, will retry" << endl;
+		m_arrival_retry.cancel();
+		m_arrival_retry = m_retry->schedule(
+		    RetryOp::ARRIVAL, m_arrival_attempt++,
+		    [this] { sendArrivalInterest(); });
+		return;
 	}
 	if (m_multicast->isReady()) {
-		Name name(m_broadcast_prefix);
-		name.append("arrival");
-		appendIpPort(name);
-		name.appendNumber(m_prefix.size()).append(m_prefix).appendTimestamp();
-
-		Interest interest(name);
-		interest.setInterestLifetime(SERVER_DISCOVERY_INTEREST_LIFETIME);
-		interest.setMustBeFresh(true);
-		interest.setNonce(4);
-		// interest.setCanBePrefix(false);
-		interest.setCanBePrefix(true);
+		// One announcement per multi-access face, each with the address of
+		// the interface it goes out on.
+		for (const auto &target : announcementFaces()) {
+			Name name(m_broadcast_prefix);
+			name.append("arrival");
+			appendIpPort(name, target.second);
+			name.appendNumber(m_prefix.size())
+			    .append(m_prefix)
+			    .appendTimestamp();
 
-		cout << "AH Client: Arrival Interest: " << interest << endl;
-
-		m_multicast->expressInterest(
-		    interest,
-		    [](const Interest &interest, const Data &data) {
-			    // Since this is multicast and we are
-			    // listening, this will almost always be from 'us',
-			    // Remotes will send an interest to the client prefix.
-			    cout << "AH Client: Arrive data " << interest.getName() << endl;
-		    },
-		    [this](const Interest &interest, const lp::Nack &nack) {
-			    // Humm, log this and retry...
-			    std::cout << "AH Client: received Nack with reason "
-			              << nack.getReason() << " for interest " << interest
-			              << std::endl;
-			    m_scheduler->schedule(time::seconds(3), [this] {
-				    sendArrivalInterestInternal();
-			    });
-		    },
-		    [](const Interest &interest) {
-			    // This is odd (we should get a packet from ourselves)...
-			    std::cout << "AH Client: Arrive Timeout (I am all alone?) "
-			              << interest << std::endl;
-		    });
+			Interest interest(name);
+			interest.setInterestLifetime(
+			    time::milliseconds(m_timing.discoveryLifetimeMs));
+			interest.setMustBeFresh(true);
+			interest.setNonce(4);
+			// interest.setCanBePrefix(false);
+			interest.setCanBePrefix(true);
+			setAnnouncementParameters(interest, true);
+
+			cout << "AH Client: Arrival Interest: " << interest << endl;
+
+			auto on_data = [this](const Interest &interest, const Data &data) {
+				// Since this is multicast and we are
+				// listening, this will almost always be from 'us',
+				// Remotes will send an interest to the client prefix.
+				cout << "AH Client: Arrive data " << interest.getName() << endl;
+				m_arrival_attempt = 0;
+			};
+			auto on_nack = [this](const Interest &interest,
+			                      const lp::Nack &nack) {
+				// Humm, log this and retry (once for all the faces)...
+				std::cout << "AH Client: received Nack with reason "
+				          << nack.getReason() << " for interest " << interest
+				          << std::endl;
+				m_arrival_retry.cancel();
+				m_arrival_retry = m_retry->schedule(
+				    RetryOp::ARRIVAL, m_arrival_attempt++,
+				    [this] { sendArrivalInterestInternal(); });
+			};
+			auto on_timeout = [this](const Interest &interest) {
+				// This is odd (we should get a packet from ourselves)...
+				std::cout << "AH Client: Arrive Timeout (I am all alone?) "
+				          << interest << std::endl;
+				// Still, it went out without a Nack, later failures start
+				// their backoff over.
+				m_arrival_attempt = 0;
+			};
+			if (target.first == 0) {
+				m_multicast->expressInterest(interest, on_data, on_nack,
+				                             on_timeout);
+			} else {
+				m_multicast->expressInterest(target.first, interest, on_data,
+				                             on_nack, on_timeout);
+			}
+		}
 	} else {
 		cout << "AH Client: Arrival Interest, multicast not ready will retry"
 		     << endl;
-		m_scheduler->schedule(time::seconds(3),
+		m_arrival_retry.cancel();
+		m_arrival_retry =
+		    m_retry->schedule(RetryOp::ARRIVAL, m_arrival_attempt++,
 		                      [this] { sendArrivalInterestInternal(); });
 	}
 }
@@ -429,40 +1002,50 @@ void AHClient::sendDepartureInterestInternal() {
 		return;
 	}
 	if (m_multicast->isReady()) {
-		Name name(m_broadcast_prefix);
-		name.append("departure");
-		appendIpPort(name);
-		name.appendNumber(m_prefix.size()).append(m_prefix).appendTimestamp();
-
-		Interest interest(name);
-		interest.setInterestLifetime(SERVER_DISCOVERY_INTEREST_LIFETIME);
-		interest.setMustBeFresh(true);
-		interest.setNonce(4);
-		interest.setCanBePrefix(true);
+		for (const auto &target : announcementFaces()) {
+			Name name(m_broadcast_prefix);
+			name.append("departure");
+			appendIpPort(name, target.second);
+			name.appendNumber(m_prefix.size())
+			    .append(m_prefix)
+			    .appendTimestamp();
 
-		cout << "AH Client: Departure Interest: " << interest << endl;
-
-		m_multicast->expressInterest(
-		    interest,
-		    [](const Interest &interest, const Data &data) {
-			    // Since this is multicast and we are
-			    // listening, this will almost always be from 'us',
-			    // Remotes will send an interest to the client prefix.
-			    cout << "AH Client: Departure data " << interest.getName()
-			         << endl;
-		    },
-		    [this](const Interest &interest, const lp::Nack &nack) {
-			    // Humm, log this and retry...
-			    std::cout << "AH Client: Departure interest received Nack "
-			                 "(will ignore) with reason "
-			              << nack.getReason() << " for interest " << interest
-			              << std::endl;
-		    },
-		    [](const Interest &interest) {
-			    // This is odd (we should get a packet from ourselves)...
-			    std::cout << "AH Client: Depart Timeout (I am all alone?) "
-			              << interest << std::endl;
-		    });
+			Interest interest(name);
+			interest.setInterestLifetime(
+			    time::milliseconds(m_timing.discoveryLifetimeMs));
+			interest.setMustBeFresh(true);
+			interest.setNonce(4);
+			interest.setCanBePrefix(true);
+
+			cout << "AH Client: Departure Interest: " << interest << endl;
+
+			auto on_data = [](const Interest &interest, const Data &data) {
+				// Since this is multicast and we are
+				// listening, this will almost always be from 'us',
+				// Remotes will send an interest to the client prefix.
+				cout << "AH Client: Departure data " << interest.getName()
+				     << endl;
+			};
+			auto on_nack = [](const Interest &interest, const lp::Nack &nack) {
+				// Humm, log this and retry...
+				std::cout << "AH Client: Departure interest received Nack "
+				             "(will ignore) with reason "
+				          << nack.getReason() << " for interest " << interest
+				          << std::endl;
+			};
+			auto on_timeout = [](const Interest &interest) {
+				// This is odd (we should get a packet from ourselves)...
+				std::cout << "AH Client: Depart Timeout (I am all alone?) "
+				          << interest << std::endl;
+			};
+			if (target.first == 0) {
+				m_multicast->expressInterest(interest, on_data, on_nack,
+				                             on_timeout);
+			} else {
+				m_multicast->expressInterest(target.first, interest, on_data,
+				                             on_nack, on_timeout);
+			}
+		}
 	} else {
 		cout << "AH Client: Departure Interest, multicast not ready will retry"
 		     << endl;
@@ -479,10 +1062,37 @@ void AHClient::sendDepartureInterest() {
 // Handle direct or multicast interests that contain a single remotes face and
 // route information.
 void AHClient::onArriveInterest(const Interest &request, const bool send_back) {
+	const auto received = time::steady_clock::now();
+	Announcement kind =
+	    send_back ? Announcement::ARRIVAL : Announcement::ND_INFO;
 	try {
 		cout << "AH Client: Got pier data " << request << endl;
+		// Announcements may carry the sender's additional prefixes and (for
+		// arrivals) a digest of the piers the sender already knows, if we are
+		// in it there is no need to send our info back.
+		bool known_by_sender = false;
+		std::vector<Name> extra_prefixes;
+		in6_addr ip6{};
+		bool has_ip6 = false;
+		if (request.hasApplicationParameters()) {
+			Block params = request.getApplicationParameters();
+			params.parse();
+			for (const auto &element : params.elements()) {
+				if (element.type() == MEMBERSHIP_DIGEST) {
+					known_by_sender = BloomFilter(element).contains(m_prefix);
+				} else if (element.type() == tlv::Name &&
+				           extra_prefixes.size() < MAX_EXTRA_PREFIXES) {
+					extra_prefixes.emplace_back(element);
+				} else if (element.type() == ADDRESS_V6 &&
+				           element.value_size() == sizeof(ip6)) {
+					memcpy(&ip6, element.value(), sizeof(ip6));
+					has_ip6 = true;
+				}
+			}
+		}
 		// First setup the face and route the pier.
 		Name const &name = request.getName();
+		bool reelect = false;
 		struct in_addr ip {};
 		uint16_t port = 0;
 		for (unsigned int i = 0; i < name.size(); i++) {
@@ -493,10 +1103,14 @@ void AHClient::onArriveInterest(const Interest &request, const bool send_back) {
 			    departure ||
 			    (component.compare(Name::Component("nd-info")) == 0)) {
 				Name::Component comp;
-				// getIP
+				// getIP, 4 bytes for IPv4 or 16 from a pier without IPv4.
 				comp = name.at(i + 1);
-				memcpy(&ip, comp.value(), sizeof(ip)); // IP_BYTES);
-				std::string ip_str(inet_ntoa(ip));
+				if (comp.value_size() == sizeof(ip6)) {
+					memcpy(&ip6, comp.value(), sizeof(ip6));
+					has_ip6 = true;
+				} else {
+					memcpy(&ip, comp.value(), sizeof(ip)); // IP_BYTES);
+				}
 				// getPort
 				comp = name.at(i + 2);
 				memcpy(&port, comp.value(), sizeof(port));
@@ -509,9 +1123,10 @@ void AHClient::onArriveInterest(const Interest &request, const bool send_back) {
 					prefix.append(name.at(begin + j + 1));
 				}
 
-				std::stringstream ss;
-				ss << "udp4://" << ip_str.data() << ':' << ntohs(port);
-				auto ss_str = ss.str();
+				// Start on IPv4 when both sides have it, raceAddresses may
+				// move the pier to IPv6 later.
+				const bool use_ip6 = ip.s_addr == 0 || m_IP.s_addr == 0;
+				auto ss_str = use_ip6 ? udpUri(ip6, port) : udpUri(ip, port);
 				if (departure) {
 					std::cout << "AH Client: Departure Name is "
 					          << prefix.toUri() << " from " << ss_str
@@ -521,93 +1136,276 @@ void AHClient::onArriveInterest(const Interest &request, const bool send_back) {
 					          << " from " << ss_str << std::endl;
 				}
 
-				// Send back empty data to confirm I am here...
-				// This is used for both arrival broadcasts and direct nd-info
-				// so always send a response even though for arrivals it might
-				// be pointless.
-				auto data = make_shared<Data>(request.getName());
-				m_keyChain.sign(*data,
-				                security::SigningInfo(
-				                    security::SigningInfo::SIGNER_TYPE_SHA256));
-				data->setFreshnessPeriod(time::milliseconds(FRESHNESS_MS));
-				m_face.put(*data);
 				// Do not register route to myself
-				// XXX- do better then a strcmp here...
-				if (strcmp(ip_str.data(), inet_ntoa(m_IP)) == 0) {
+				if (isLocalAddress(ip) || (has_ip6 && isLocalAddress(ip6))) {
 					cout << "AH Client: My IP address returned." << endl;
+					// Ack our own arrival right away, the acks of the other
+					// members are delayed and left to a few of them so this
+					// is what tells us the announcement went out.
+					if (send_back && !departure && prefix.equals(m_prefix)) {
+						m_face.put(m_replies->ack.make(request.getName()));
+					}
 					continue;
 				}
-				if (departure) {
-					int db_i = 0;
-					for (auto it = m_db.begin(); it != m_db.end();) {
-						if (it->prefix.equals(prefix)) {
-							cout << "AH Client: Found record, removing route "
-							        "and face."
-							     << endl;
-							removeRouteAndFace(prefix, it->faceId);
-							it->prefix.clear();
-							m_db_free.push_back(db_i);
-						}
-						db_i++;
-						++it;
+				if (use_ip6 && (!has_ip6 || !m_has_ip6)) {
+					cout << "AH Client: No common address family with "
+					     << prefix << endl;
+					continue;
+				}
+				// Nothing is signed or asked of NFD for an announcement
+				// that is not admitted.
+				const Verdict verdict = m_admission->admit(
+				    use_ip6 ? ip6String(ip6) : std::string(inet_ntoa(ip)),
+				    !departure && !hasEntry(prefix),
+				    pierCounts(ip, ip6, use_ip6));
+				if (verdict != Verdict::ADMIT) {
+					m_stats->rejected(verdict);
+					if (verdict == Verdict::OVERLOADED) {
+						deferAnnouncement(request, send_back, prefix);
 					}
-				} else {
-					if (!hasEntry(prefix)) {
-						DBEntry &entry = newItem();
-						// entry.ip.swap(ip);
-						entry.ip = ip;
-						entry.port = port;
-						entry.prefix = prefix;
-						addFaceAndPrefix(ss_str, prefix, entry, send_back);
+					continue;
+				}
+				if (m_election != nullptr) {
+					if (departure) {
+						reelect = m_election->forget(prefix) || reelect;
 					} else {
-						// We already know about them but they may not know
-						// about us... Do not bother with removing face/route
-						// (keepalive should handle that).
-						if (send_back) {
-							sendData(prefix, 0);
+						reelect =
+						    m_election->heard({prefix, ip, ip6, has_ip6, port,
+						                       received, extra_prefixes}) ||
+						    reelect;
+						// Neither of us is a delegate, the pier is reached
+						// through them and gets no face or route.  A direct
+						// nd-info is still acked, while the election views
+						// converge the sender may count us as a delegate and
+						// would tear us down after its retries ran out.
+						if (!hasEntry(prefix) && !wantsPier(prefix)) {
+							if (!send_back) {
+								m_face.put(
+								    m_replies->ack.make(request.getName()));
+								cancelArrivalReply(prefix);
+							}
+							continue;
 						}
 					}
 				}
+				if (departure) {
+					kind = Announcement::DEPARTURE;
+					// Nobody waits for an ack of a departure.
+					cancelArrivalReply(prefix);
+					for (auto it = m_deferred.begin(); it != m_deferred.end();) {
+						it = it->prefix.equals(prefix) ? m_deferred.erase(it)
+						                               : it + 1;
+					}
+				} else if (send_back) {
+					// Multicast arrival, every member of the segment gets
+					// this so our ack and info are sent after a random delay
+					// (see scheduleArrivalReply).
+					if (known_by_sender) {
+						cancelArrivalReply(prefix);
+					} else {
+						scheduleArrivalReply(request, prefix);
+					}
+				} else {
+					// Send back empty data to confirm I am here...
+					// Direct nd-info needs this as the confirmation.
+					m_face.put(m_replies->ack.make(request.getName()));
+					// They know about us, no need to answer an arrival.
+					cancelArrivalReply(prefix);
+				}
+				if (departure) {
+					m_tracer->span("departure", traceTrack(prefix), received);
+					teardownPier(prefix);
+				} else if (!hasEntry(prefix)) {
+					DBEntry &entry = newItem();
+					// entry.ip.swap(ip);
+					entry.ip = ip;
+					entry.ip6 = ip6;
+					entry.hasIp6 = has_ip6;
+					entry.useIp6 = use_ip6;
+					entry.port = port;
+					entry.prefix = prefix;
+					entry.extraPrefixes = extra_prefixes;
+					entry.link = udpLinkClass(ip);
+					entry.discovered = received;
+					if (!send_back) {
+						entry.heard = received;
+					}
+					m_tracer->nameTrack(entry.track, prefix.toUri());
+					m_tracer->span(send_back ? "arrival" : "nd-info received",
+					              entry.track, received);
+					// Any reply to an arrival is sent by scheduleArrivalReply.
+					addFaceAndPrefix(ss_str, prefix, false);
+				} else {
+					DBEntry &entry = *findItem(prefix);
+					m_tracer->span(send_back ? "arrival" : "nd-info received",
+					              entry.track, received);
+					if (!send_back) {
+						entry.heard = received;
+					}
+					updateExtraPrefixes(entry, extra_prefixes);
+					const bool new_ip6 =
+					    has_ip6 && (!entry.hasIp6 ||
+					                memcmp(&entry.ip6, &ip6, sizeof(ip6)) != 0);
+					if (new_ip6 && !entry.useIp6) {
+						entry.ip6 = ip6;
+						entry.hasIp6 = true;
+						raceAddresses(prefix);
+					}
+					// While the face or route is being set up this arrival is
+					// covered by the operation in flight.
+					if (!use_ip6 && !entry.useIp6 && entry.raceFaceId == 0 &&
+					    entry.state == PierState::CONFIRMED) {
+						movePier(entry, ip, port, ss_str);
+					}
+				}
 			}
 		}
+		if (reelect) {
+			applyElection();
+		}
 	} catch (const std::runtime_error &e) {
 		cout << "AH Client: ERROR on request " << request
 		     << ", message: " << e.what() << endl;
 	}
+	m_stats->announcement(kind, time::steady_clock::now() - received);
+}
+
+void AHClient::scheduleArrivalReply(const Interest &request,
+                                    const Name &prefix) {
+	if (m_pending_replies.count(prefix) != 0) {
+		// Already answering this pier, coalesce.
+		return;
+	}
+	// Spread the replies of the whole segment over a window that grows with
+	// the group size.  Only a few members need to satisfy the multicast
+	// interest itself, our info is always sent unless suppressed first.
+	const size_t group = pierCount() + 1;
+	const long window_ms =
+	    std::min(m_timing.arrivalReplySlotMs * static_cast<long>(group),
+	             m_timing.arrivalReplyMaxMs);
+	auto &rng = random::getRandomNumberEngine();
+	std::uniform_int_distribution<long> delay_dist(0, window_ms);
+	std::bernoulli_distribution ack_dist(
+	    std::min(1.0, ARRIVAL_ACKS / static_cast<double>(group)));
+	const bool send_ack = ack_dist(rng);
+	const auto delay = time::milliseconds(delay_dist(rng));
+	cout << "AH Client: Replying to arrival of " << prefix << " in "
+	     << delay.count() << "ms" << endl;
+	const Name data_name = request.getName();
+	m_pending_replies[prefix] =
+	    m_scheduler->schedule(delay, [this, prefix, data_name, send_ack] {
+		    m_pending_replies.erase(prefix);
+		    if (send_ack) {
+			    m_face.put(m_replies->ack.make(data_name));
+		    }
+		    requestInfo(prefix);
+	    });
+}
+
+void AHClient::cancelArrivalReply(const Name &prefix) {
+	auto pending = m_pending_replies.find(prefix);
+	if (pending != m_pending_replies.end()) {
+		cout << "AH Client: Suppressing reply to " << prefix
+		     << ", already satisfied." << endl;
+		pending->second.cancel();
+		m_pending_replies.erase(pending);
+	}
+}
+
+auto AHClient::expressCommand(const Interest &interest,
+                              const DataCallback &on_data,
+                              const NackCallback &on_nack,
+                              const TimeoutCallback &on_timeout)
+    -> PendingInterestHandle {
+	// Dropped with the callbacks whichever way the command ends.
+	auto ticket = m_stats->command();
+	return m_face.expressInterest(
+	    interest,
+	    [ticket, on_data](const Interest &interest, const Data &data) {
+		    on_data(interest, data);
+	    },
+	    on_nack, on_timeout);
+}
+
+auto AHClient::traceTrack(const Name &prefix) -> long {
+	const DBEntry *entry = findItem(prefix);
+	return entry == nullptr ? 0 : entry->track;
+}
+
+auto AHClient::getStats() -> std::string {
+	return m_stats->json(pierCount(), m_retry->pending(), m_retry->queued());
 }
 
+void AHClient::resetStats() { m_stats->reset(); }
+
+auto AHClient::getTrace() -> std::string { return m_tracer->json(); }
+
+void AHClient::setTracing(bool enabled) { m_tracer->setEnabled(enabled); }
+
+void AHClient::clearTrace() { m_tracer->clear(); }
+
 void AHClient::registerRoute(const Name &route_name, int face_id, int cost,
-                             const bool send_data) {
+                             const bool send_data, const int attempt) {
 	Interest interest =
-	    prepareRibRegisterInterest(route_name, face_id, m_keyChain);
-	m_face.expressInterest(
+	    prepareRibRegisterInterest(route_name, face_id, cost, m_keyChain);
+	const auto sent = time::steady_clock::now();
+	auto handle = expressCommand(
 	    interest,
-	    [this, route_name, face_id, cost, send_data](auto &&interest,
-	                                                 auto &&data) {
+	    [=](auto &&interest, auto &&data) {
+		    m_tracer->span("rib/register", traceTrack(route_name), sent,
+		                  attempt);
 		    onRegisterRouteDataReply(interest, data, route_name, face_id, cost,
-		                             send_data);
+		                             send_data, attempt);
 	    },
-	    [this, route_name, face_id, cost, send_data](const Interest &interest,
-	                                                 const lp::Nack &nack) {
+	    [=](const Interest &interest, const lp::Nack &nack) {
 		    std::cout << "AH Client: Received Nack with reason "
 		              << nack.getReason() << " for interest " << interest
 		              << std::endl;
-		    m_scheduler->schedule(
-		        time::seconds(3), [this, route_name, face_id, cost, send_data] {
-			        registerRoute(route_name, face_id, cost, send_data);
-		        });
+		    m_tracer->span("rib/register failed", traceTrack(route_name), sent,
+		                  attempt);
+		    retryRoute(route_name, face_id, cost, send_data, attempt);
 	    },
-	    [this, route_name, face_id, cost, send_data](const Interest &interest) {
+	    [=](const Interest &interest) {
 		    std::cout << "AH Client: Received timeout for interest " << interest
 		              << std::endl;
-		    // XXX TODO- this may be wrong, may want to unwind the route and
-		    // face on timeout here- also see nack above.
-		    // removeRoute(findEntry(interest.getName()));
-		    m_scheduler->schedule(
-		        time::seconds(3), [this, route_name, face_id, cost, send_data] {
-			        registerRoute(route_name, face_id, cost, send_data);
-		        });
+		    m_tracer->span("rib/register failed", traceTrack(route_name), sent,
+		                  attempt);
+		    retryRoute(route_name, face_id, cost, send_data, attempt);
 	    });
+	if (isPendingRoute(route_name, face_id)) {
+		pierOps(route_name).command = handle;
+	}
+}
+
+auto AHClient::isPendingRoute(const Name &route_name, const int face_id)
+    -> bool {
+	const DBEntry *entry = findItem(route_name);
+	return entry != nullptr && entry->faceId == face_id &&
+	       entry->state == PierState::ROUTE_PENDING;
+}
+
+void AHClient::retryRoute(const Name &route_name, const int face_id,
+                          const int cost, const bool send_data,
+                          const int attempt) {
+	if (!RetryPolicy::canRetry(RetryOp::ROUTE, attempt)) {
+		cout << "AH Client: Giving up on route " << route_name << " on face "
+		     << face_id << endl;
+		if (isPendingRoute(route_name, face_id)) {
+			// A pier without its route is no use, it starts over when it
+			// announces again.
+			teardownPier(route_name);
+		}
+		return;
+	}
+	const auto waiting = time::steady_clock::now();
+	auto retry = m_retry->schedule(RetryOp::ROUTE, attempt, [=] {
+		m_tracer->span("route retry wait", traceTrack(route_name), waiting,
+		              attempt + 1);
+		registerRoute(route_name, face_id, cost, send_data, attempt + 1);
+	});
+	if (isPendingRoute(route_name, face_id)) {
+		pierOps(route_name).commandRetry = retry;
+	}
 }
 
 void AHClient::sendKeepAliveInterest() {
@@ -615,55 +1413,677 @@ void AHClient::sendKeepAliveInterest() {
 	// multicast route active and may eventually correct any issues with a
 	// client not getting the initial broadcast.
 	sendArrivalInterest();
-	for (auto it = m_db.begin(); it != m_db.end();) {
-		// for (auto it = m_db.begin(); it != m_db.end(); it = m_db.erase(it)) {
-		const DBEntry item = *it;
-		if (item.prefix.empty()) {
-			++it;
+	if (m_election != nullptr &&
+	    m_election->expire(time::steady_clock::now() -
+	                       time::seconds(m_timing.keepaliveSeconds *
+	                                     ELECTION_EXPIRY_ROUNDS))) {
+		applyElection();
+	}
+	if (m_timing.passiveLiveness == 0) {
+		probeIdlePiers(nullptr);
+		return;
+	}
+	m_statusinfo->getFaces(
+	    [this](const std::vector<nfd::FaceStatus> &faces) {
+		    probeIdlePiers(&faces);
+	    },
+	    [this](const std::string &reason) {
+		    cout << "AH Client: " << reason << ", probing all piers." << endl;
+		    probeIdlePiers(nullptr);
+	    });
+}
+
+void AHClient::probeIdlePiers(const std::vector<nfd::FaceStatus> *faces) {
+	std::unordered_map<uint64_t, const nfd::FaceStatus *> by_id;
+	if (faces != nullptr) {
+		for (const auto &face : *faces) {
+			by_id[face.getFaceId()] = &face;
+		}
+	}
+	const auto now = time::steady_clock::now();
+	const auto period = time::seconds(m_timing.keepaliveSeconds);
+	size_t sent = 0;
+	size_t passive = 0;
+	for (auto &item : m_db) {
+		// Piers still being set up have an NFD command in flight, its
+		// failure removes them.
+		if (item.prefix.empty() || (item.state != PierState::CONFIRMED &&
+		                            item.state != PierState::SUSPECT)) {
 			continue;
 		}
-		Name name(item.prefix);
-		name.append("nd-keepalive");
-		name.appendTimestamp();
-		Interest interest(name);
-		interest.setInterestLifetime(INTEREST_LIFETIME);
-		interest.setMustBeFresh(true);
-		interest.setNonce(4);
-		interest.setCanBePrefix(false);
+		bool alive = faces != nullptr && now - item.heard < period;
+		const auto face = by_id.find(item.faceId);
+		if (face != by_id.end()) {
+			// Interests or data coming in on the pier's face mean it is up,
+			// the counters are only compared on the face they were read from.
+			const uint64_t in_interests = face->second->getNInInterests();
+			const uint64_t in_data = face->second->getNInData();
+			alive = alive || (item.countersFaceId == item.faceId &&
+			                  (in_interests != item.faceInInterests ||
+			                   in_data != item.faceInData));
+			item.countersFaceId = item.faceId;
+			item.faceInInterests = in_interests;
+			item.faceInData = in_data;
+		}
+		// A suspect pier already missed a probe, only an answer clears it.
+		if (alive && item.state == PierState::CONFIRMED) {
+			passive++;
+		} else {
+			sendKeepAlive(item.prefix);
+			sent++;
+		}
+	}
+	if (faces != nullptr) {
+		cout << "AH Client: Keepalive round probed " << sent << " piers, "
+		     << passive << " heard from on their own." << endl;
+	}
+	m_stats->keepalives(sent, passive);
+}
 
-		cout << "AH Client: Sending keep alive to " << interest.getName()
-		     << endl;
-		m_face.expressInterest(
-		    interest,
-		    [item](const Interest &interest, const Data &data) {
-			    cout << "AH Client: Got keep alive response from "
-			         << interest.getName() << endl;
-		    },
-		    [item, this](const Interest &interest, const lp::Nack &nack) {
-			    // Humm, log this and remove.
-			    std::cout << "AH Client: received keep alive Nack with reason "
-			                 "(Removing) "
-			              << nack.getReason() << " for interest " << interest
-			              << std::endl;
-			    auto prefix = item.prefix;
-			    auto face_id = item.faceId;
-			    removeItem(item);
-			    removeRouteAndFace(prefix, face_id);
-		    },
-		    [item, this](const Interest &interest) {
-			    std::cout << "AH Client: Keep alive timeout (Removing) "
-			              << interest << std::endl;
-			    auto prefix = item.prefix;
-			    auto face_id = item.faceId;
-			    removeItem(item);
-			    removeRouteAndFace(prefix, face_id);
-		    });
-		++it;
+void AHClient::heardOn(const uint64_t face_id) {
+	for (auto &item : m_db) {
+		if (!item.prefix.empty() &&
+		    static_cast<uint64_t>(item.faceId) == face_id) {
+			item.heard = time::steady_clock::now();
+		}
 	}
 }
 
-void AHClient::onNack(const Interest &interest, const lp::Nack &nack) {
-	std::cout << "AH Client: received Nack with reason " << nack.getReason()
+void AHClient::sendKeepAlive(const Name &prefix) {
+	Name name(prefix);
+	name.append("nd-keepalive");
+	name.appendTimestamp();
+	Interest interest(name);
+	interest.setInterestLifetime(
+	    time::milliseconds(m_timing.interestLifetimeMs));
+	interest.setMustBeFresh(true);
+	interest.setNonce(4);
+	interest.setCanBePrefix(false);
+
+	cout << "AH Client: Sending keep alive to " << interest.getName() << endl;
+	const auto sent = time::steady_clock::now();
+	pierOps(prefix).keepalive = m_face.expressInterest(
+	    interest,
+	    [prefix, sent, this](const Interest &interest, const Data &data) {
+		    cout << "AH Client: Got keep alive response from "
+		         << interest.getName() << endl;
+		    onRttSample(prefix, time::steady_clock::now() - sent);
+		    DBEntry *entry = findItem(prefix);
+		    if (entry == nullptr) {
+			    return;
+		    }
+		    // Our own probe's answer is not a sign the pier is in use, keep
+		    // it out of the face's data count.
+		    if (entry->countersFaceId == entry->faceId) {
+			    entry->faceInData++;
+		    }
+		    if (entry->state == PierState::SUSPECT) {
+			    setState(*entry, PierState::CONFIRMED);
+		    }
+	    },
+	    [prefix, this](const Interest &interest, const lp::Nack &nack) {
+		    std::cout << "AH Client: received keep alive Nack with reason "
+		              << nack.getReason() << " for interest " << interest
+		              << std::endl;
+		    onKeepAliveFailed(prefix);
+	    },
+	    [prefix, this](const Interest &interest) {
+		    std::cout << "AH Client: Keep alive timeout " << interest
+		              << std::endl;
+		    onKeepAliveFailed(prefix);
+	    });
+}
+
+void AHClient::onKeepAliveFailed(const Name &prefix) {
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr) {
+		return;
+	}
+	if (entry->state == PierState::CONFIRMED) {
+		// One more chance, a single lost keepalive should not cost the
+		// pier its face.
+		setState(*entry, PierState::SUSPECT);
+		pierOps(prefix).suspectProbe = m_scheduler->schedule(
+		    time::seconds(m_timing.suspectProbeSeconds), [this, prefix] {
+			    const DBEntry *entry = findItem(prefix);
+			    if (entry != nullptr && entry->state == PierState::SUSPECT) {
+				    sendKeepAlive(prefix);
+			    }
+		    });
+	} else if (entry->state == PierState::SUSPECT) {
+		cout << "AH Client: " << prefix << " is not answering (Removing)"
+		     << endl;
+		teardownPier(prefix);
+		if (m_election != nullptr && m_election->forget(prefix)) {
+			applyElection();
+		}
+	}
+}
+
+void AHClient::setState(DBEntry &entry, const PierState state) {
+	if (entry.state == state) {
+		return;
+	}
+	cout << "AH Client: Pier " << entry.prefix << " "
+	     << pierStateName(entry.state) << " -> " << pierStateName(state)
+	     << endl;
+	entry.state = state;
+}
+
+void AHClient::confirmPier(DBEntry &entry) {
+	setState(entry, PierState::CONFIRMED);
+	const Name prefix = entry.prefix;
+	if (entry.discovered != time::steady_clock::time_point()) {
+		m_tracer->span("provisioning", entry.track, entry.discovered);
+		m_stats->provisioned(time::steady_clock::now() - entry.discovered);
+		entry.discovered = time::steady_clock::time_point();
+	}
+	if (m_events.pierUp) {
+		m_events.pierUp(entry);
+	}
+	if (m_ether_faces && !entry.useIp6 && interfaceFor(entry.ip) != nullptr) {
+		pierOps(prefix).etherLookup =
+		    m_scheduler->schedule(time::seconds(ETHER_LOOKUP_SECONDS),
+		                          [this, prefix] { tryEtherFace(prefix); });
+	} else {
+		raceAddresses(prefix);
+	}
+	if (entry.infoWanted) {
+		entry.infoWanted = false;
+		requestInfo(prefix);
+	}
+	readmitDeferred();
+}
+
+void AHClient::teardownPier(const Name &prefix) {
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr || entry->state == PierState::TEARING_DOWN) {
+		return;
+	}
+	const bool was_up = entry->state == PierState::CONFIRMED ||
+	                    entry->state == PierState::SUSPECT;
+	setState(*entry, PierState::TEARING_DOWN);
+	if (was_up && m_events.pierDown) {
+		m_events.pierDown(*entry);
+	}
+	cancelArrivalReply(prefix);
+	const int face_id = entry->faceId;
+	removeItem(*entry);
+	if (face_id > 0) {
+		removeRouteAndFace(prefix, face_id);
+	}
+	readmitDeferred();
+}
+
+void AHClient::setLocalFields(const bool enabled) {
+	m_multicast->setMayEnableLocalFields(enabled || m_owned_face != nullptr);
+}
+
+void AHClient::setDelegates(const size_t count) {
+	if (count == 0) {
+		m_election.reset();
+		return;
+	}
+	m_election = make_unique<Election>(m_prefix, count);
+	applyElection();
+}
+
+auto AHClient::getElection() -> std::string {
+	return m_election == nullptr ? R"({"delegates":0})" : m_election->json();
+}
+
+auto AHClient::wantsPier(const Name &prefix) -> bool {
+	return m_election == nullptr || m_election->selfDelegate() ||
+	       m_election->isDelegate(prefix);
+}
+
+void AHClient::applyElection() {
+	if (m_election == nullptr) {
+		return;
+	}
+	cout << "AH Client: Delegates " << m_election->json() << endl;
+	std::vector<Name> unwanted;
+	for (const auto &item : m_db) {
+		if (!item.prefix.empty() && !wantsPier(item.prefix)) {
+			unwanted.push_back(item.prefix);
+		}
+	}
+	for (const auto &prefix : unwanted) {
+		cout << "AH Client: " << prefix << " is not a delegate (Removing)"
+		     << endl;
+		teardownPier(prefix);
+	}
+	for (const auto &member : m_election->delegates()) {
+		if (hasEntry(member.prefix)) {
+			continue;
+		}
+		// Set up from its last announcement, as if it just arrived.
+		const bool use_ip6 = member.ip.s_addr == 0 || m_IP.s_addr == 0;
+		if (use_ip6 && (!member.hasIp6 || !m_has_ip6)) {
+			continue;
+		}
+		DBEntry &entry = newItem();
+		entry.ip = member.ip;
+		entry.ip6 = member.ip6;
+		entry.hasIp6 = member.hasIp6;
+		entry.useIp6 = use_ip6;
+		entry.port = member.port;
+		entry.prefix = member.prefix;
+		entry.extraPrefixes = member.extraPrefixes;
+		entry.link = udpLinkClass(member.ip);
+		entry.discovered = time::steady_clock::now();
+		m_tracer->nameTrack(entry.track, member.prefix.toUri());
+		addFaceAndPrefix(use_ip6 ? udpUri(member.ip6, member.port)
+		                         : udpUri(member.ip, member.port),
+		                 member.prefix, false);
+		// Our nd-info goes out once its route is up.
+		requestInfo(member.prefix);
+	}
+}
+
+auto AHClient::pierOps(const Name &prefix) -> PierOps & {
+	return m_pier_ops[prefix];
+}
+
+void AHClient::requestInfo(const Name &prefix) {
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr || entry->state == PierState::TEARING_DOWN) {
+		return;
+	}
+	if (entry->state != PierState::CONFIRMED &&
+	    entry->state != PierState::SUSPECT) {
+		// Without its route the interest would only be Nacked.
+		entry->infoWanted = true;
+		return;
+	}
+	if (entry->infoPending) {
+		// One exchange answers any number of arrivals.
+		return;
+	}
+	entry->infoPending = true;
+	sendData(prefix, entry->faceId);
+}
+
+auto AHClient::isDirectPrefix(const Name &name) -> bool {
+	for (const auto &item : m_db) {
+		if (item.prefix.empty()) {
+			continue;
+		}
+		if (item.prefix.equals(name) ||
+		    std::find(item.extraPrefixes.begin(), item.extraPrefixes.end(),
+		              name) != item.extraPrefixes.end()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+auto AHClient::gossipEntries(const Name &exclude_via)
+    -> std::vector<PierListEntry> {
+	std::vector<PierListEntry> entries;
+	for (const auto &item : m_db) {
+		if (item.prefix.empty() || item.faceId <= 0) {
+			continue;
+		}
+		entries.push_back({item.prefix, 1});
+		for (const auto &extra : item.extraPrefixes) {
+			entries.push_back({extra, 1});
+		}
+	}
+	for (const auto &route : m_gossip_routes) {
+		// Split horizon, do not tell a pier about routes through itself.
+		if (route.second.hops < GOSSIP_MAX_HOPS &&
+		    !route.second.via.equals(exclude_via)) {
+			entries.push_back({route.first, route.second.hops});
+		}
+	}
+	return entries;
+}
+
+auto AHClient::gossipVersion(const Name &requester,
+                             const std::vector<PierListEntry> &entries)
+    -> uint64_t {
+	GossipView &view = m_gossip_views[requester];
+	bool same = view.version != 0 && entries.size() == view.entries.size();
+	for (size_t i = 0; same && i < entries.size(); i++) {
+		same = entries.at(i).prefix.equals(view.entries.at(i).first) &&
+		       entries.at(i).hops == view.entries.at(i).second;
+	}
+	if (!same) {
+		view.version = ++m_gossip_version;
+		view.entries.clear();
+		for (const auto &entry : entries) {
+			view.entries.emplace_back(entry.prefix, entry.hops);
+		}
+	}
+	return view.version;
+}
+
+void AHClient::onGossipInterest(const Interest &request) {
+	try {
+		// Name: /<prefix>/nd-gossip/<known version>/<offset>/<prefix_length>/
+		//       <prefix>/<timestamp>
+		const Name &name = request.getName();
+		for (unsigned int i = 0; i < name.size(); i++) {
+			if (name.at(i).compare(Name::Component("nd-gossip")) != 0) {
+				continue;
+			}
+			const uint64_t known_version = name.at(i + 1).toNumber();
+			const uint64_t requested_offset = name.at(i + 2).toNumber();
+			const uint64_t name_size = name.at(i + 3).toNumber();
+			Name requester;
+			for (unsigned int j = 0; j < name_size; j++) {
+				requester.append(name.at(i + 4 + j));
+			}
+			std::vector<PierListEntry> entries = gossipEntries(requester);
+			const uint64_t version = gossipVersion(requester, entries);
+			// A page of a version that is gone starts over with the current
+			// one, the requester sees the offset and version change.
+			size_t offset = 0;
+			if (known_version == version) {
+				if (requested_offset == 0) {
+					entries.clear();
+				} else if (requested_offset < entries.size()) {
+					offset = requested_offset;
+				}
+			}
+			cout << "AH Client: Gossip request from " << requester
+			     << ", sending from entry " << offset << " of "
+			     << entries.size() << " (version " << version << ")" << endl;
+			// The entries are a snapshot, paging, encoding and signing the
+			// list happens on a worker.
+			auto data = make_shared<Data>();
+			m_workers->submit(
+			    [data, name, version, offset, entries = std::move(entries),
+			     freshness = m_timing.freshnessMs] {
+				    const size_t used =
+				        name.wireEncode().size() + GOSSIP_DATA_OVERHEAD;
+				    const size_t budget = used < MAX_NDN_PACKET_SIZE
+				                              ? MAX_NDN_PACKET_SIZE - used
+				                              : 0;
+				    const Block list =
+				        PierList::page(version, entries, offset, budget)
+				            .wireEncode();
+				    const Buffer content(list.begin(), list.end());
+				    *data =
+				        DataTemplate(time::milliseconds(freshness), content)
+				            .make(name);
+			    },
+			    [this, data, requester] {
+				    // Put throws on a packet over the size limit, that must
+				    // not take the I/O thread down.
+				    try {
+					    m_face.put(*data);
+				    } catch (const std::exception &e) {
+					    cout << "AH Client: ERROR sending gossip to "
+					         << requester << ", message: " << e.what()
+					         << endl;
+				    }
+			    });
+			break;
+		}
+	} catch (const std::runtime_error &e) {
+		cout << "AH Client: ERROR on gossip request " << request
+		     << ", message: " << e.what() << endl;
+	}
+}
+
+void AHClient::sendGossip() {
+	expireGossipRoutes();
+	std::vector<Name> piers;
+	for (const auto &item : m_db) {
+		// With delegates only they know the whole segment, a delegate has
+		// every other member as a direct pier already.
+		if (!item.prefix.empty() && item.faceId > 0 &&
+		    (m_election == nullptr || m_election->isDelegate(item.prefix))) {
+			piers.push_back(item.prefix);
+		}
+	}
+	if (piers.empty()) {
+		return;
+	}
+	// Round robin so every pier is pulled from within N / GOSSIP_FANOUT rounds,
+	// this bounds how stale routes learned from it can get.
+	const size_t count = std::min(GOSSIP_FANOUT, piers.size());
+	for (size_t i = 0; i < count; i++) {
+		const Name pier = piers.at((m_gossip_next + i) % piers.size());
+		const auto seen = m_gossip_seen.find(pier);
+		// A pull still going from the last round starts over.
+		m_gossip_pulls.erase(pier);
+		requestGossip(pier, seen == m_gossip_seen.end() ? 0 : seen->second,
+		              0);
+	}
+	m_gossip_next = (m_gossip_next + count) % piers.size();
+}
+
+void AHClient::requestGossip(const Name &pier, const uint64_t known_version,
+                             const uint64_t offset) {
+	Name name(pier);
+	name.append("nd-gossip")
+	    .appendNumber(known_version)
+	    .appendNumber(offset)
+	    .appendNumber(m_prefix.size())
+	    .append(m_prefix)
+	    .appendTimestamp();
+	Interest interest(name);
+	interest.setInterestLifetime(
+	    time::milliseconds(m_timing.discoveryLifetimeMs));
+	interest.setMustBeFresh(true);
+	interest.setCanBePrefix(false);
+
+	cout << "AH Client: Sending gossip request to " << pier << " (from entry "
+	     << offset << ")" << endl;
+	const auto sent = time::steady_clock::now();
+	m_face.expressInterest(
+	    interest,
+	    [this, pier, sent](const Interest &interest, const Data &data) {
+		    onRttSample(pier, time::steady_clock::now() - sent);
+		    onGossipData(pier, data);
+	    },
+	    [](const Interest &interest, const lp::Nack &nack) {
+		    std::cout << "AH Client: Gossip request Nack with reason "
+		              << nack.getReason() << " for interest " << interest
+		              << std::endl;
+	    },
+	    [this, pier](const Interest &interest) {
+		    std::cout << "AH Client: Gossip request timeout " << interest
+		              << std::endl;
+		    onRttLoss(pier);
+	    });
+}
+
+void AHClient::onGossipData(const Name &pier, const Data &data) {
+	try {
+		const DBEntry *entry = findItem(pier);
+		if (entry == nullptr || entry->faceId <= 0) {
+			return;
+		}
+		const int face_id = entry->faceId;
+		PierList list(data.getContent().blockFromValue());
+		const auto seen = m_gossip_seen.find(pier);
+		if (seen != m_gossip_seen.end() && seen->second == list.version() &&
+		    list.offset() == 0 && list.entries().empty()) {
+			// Not modified.
+			return;
+		}
+		GossipPull &pull = m_gossip_pulls[pier];
+		if (list.offset() == 0) {
+			pull.version = list.version();
+			pull.entries.clear();
+		} else if (list.version() != pull.version ||
+		           list.offset() != pull.entries.size()) {
+			// Out of step, the next round starts over.
+			m_gossip_pulls.erase(pier);
+			return;
+		}
+		for (const auto &e : list.entries()) {
+			pull.entries.emplace_back(e.prefix, e.hops);
+		}
+		if (pull.entries.size() > MAX_GOSSIP_ENTRIES ||
+		    (list.next() != 0 && list.next() != pull.entries.size())) {
+			cout << "AH Client: Dropping pier list from " << pier << endl;
+			m_gossip_pulls.erase(pier);
+			return;
+		}
+		if (list.next() != 0) {
+			requestGossip(pier, list.version(), list.next());
+			return;
+		}
+		const auto listed = std::move(pull.entries);
+		m_gossip_pulls.erase(pier);
+		m_gossip_seen[pier] = list.version();
+		// Drop what this pier no longer advertises.
+		std::set<Name> names;
+		for (const auto &e : listed) {
+			names.insert(e.first);
+		}
+		for (auto it = m_gossip_routes.begin(); it != m_gossip_routes.end();) {
+			if (it->second.via.equals(pier) && names.count(it->first) == 0) {
+				removeRoute(it->first, it->second.faceId);
+				it = m_gossip_routes.erase(it);
+			} else {
+				++it;
+			}
+		}
+		for (const auto &e : listed) {
+			learnGossipRoute(e.first, e.second + 1, pier, face_id);
+		}
+	} catch (const std::runtime_error &e) {
+		cout << "AH Client: ERROR on gossip data from " << pier
+		     << ", message: " << e.what() << endl;
+	}
+}
+
+void AHClient::learnGossipRoute(const Name &prefix, const uint64_t hops,
+                                const Name &via, const int face_id) {
+	if (hops > GOSSIP_MAX_HOPS || prefix.equals(m_prefix) ||
+	    std::find(m_extra_prefixes.begin(), m_extra_prefixes.end(), prefix) !=
+	        m_extra_prefixes.end() ||
+	    isDirectPrefix(prefix)) {
+		return;
+	}
+	const DBEntry *pier = findItem(via);
+	const int cost = (pier == nullptr ? 0 : pier->cost) +
+	                 ROUTE_HOP_COST * static_cast<int>(hops - 1);
+	auto it = m_gossip_routes.find(prefix);
+	if (it != m_gossip_routes.end()) {
+		if (it->second.via.equals(via)) {
+			if (it->second.hops != hops) {
+				it->second.hops = hops;
+				registerRoute(prefix, face_id, cost, false);
+			}
+			return;
+		}
+		if (it->second.hops <= hops) {
+			return;
+		}
+		removeRoute(prefix, it->second.faceId);
+	}
+	cout << "AH Client: Learned " << prefix << " via " << via << " (" << hops
+	     << " hops)" << endl;
+	m_gossip_routes[prefix] = {via, face_id, hops};
+	registerRoute(prefix, face_id, cost, false);
+}
+
+void AHClient::expireGossipRoutes() {
+	// Routes through a pier that is gone went with its face, ones for a
+	// prefix that is now a direct pier are redundant.
+	for (auto it = m_gossip_routes.begin(); it != m_gossip_routes.end();) {
+		const DBEntry *via = findItem(it->second.via);
+		if (via == nullptr || via->faceId != it->second.faceId ||
+		    isDirectPrefix(it->first)) {
+			removeRoute(it->first, it->second.faceId);
+			it = m_gossip_routes.erase(it);
+		} else {
+			++it;
+		}
+	}
+	for (auto it = m_gossip_seen.begin(); it != m_gossip_seen.end();) {
+		if (findItem(it->first) == nullptr) {
+			it = m_gossip_seen.erase(it);
+		} else {
+			++it;
+		}
+	}
+	for (auto it = m_gossip_pulls.begin(); it != m_gossip_pulls.end();) {
+		if (findItem(it->first) == nullptr) {
+			it = m_gossip_pulls.erase(it);
+		} else {
+			++it;
+		}
+	}
+	for (auto it = m_gossip_views.begin(); it != m_gossip_views.end();) {
+		if (findItem(it->first) == nullptr) {
+			it = m_gossip_views.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+void AHClient::onRttSample(const Name &pier, const time::nanoseconds rtt) {
+	DBEntry *entry = findItem(pier);
+	if (entry == nullptr) {
+		return;
+	}
+	const double sample_ms =
+	    static_cast<double>(
+	        time::duration_cast<time::microseconds>(rtt).count()) /
+	    1000.0;
+	if (entry->rttSamples == 0) {
+		entry->srttMs = sample_ms;
+	} else {
+		entry->srttMs += RTT_GAIN * (sample_ms - entry->srttMs);
+	}
+	entry->rttSamples++;
+	entry->lossRate -= LOSS_GAIN * entry->lossRate;
+	updateRouteCost(*entry);
+	adjustFaceProfile(*entry);
+}
+
+void AHClient::onRttLoss(const Name &pier) {
+	DBEntry *entry = findItem(pier);
+	if (entry == nullptr) {
+		return;
+	}
+	entry->lossRate += LOSS_GAIN * (1.0 - entry->lossRate);
+	updateRouteCost(*entry);
+	adjustFaceProfile(*entry);
+}
+
+void AHClient::updateRouteCost(DBEntry &entry) {
+	if (entry.faceId <= 0 || entry.rttSamples == 0) {
+		return;
+	}
+	const int cost = static_cast<int>(
+	    std::min(entry.srttMs * (1.0 + LOSS_COST_FACTOR * entry.lossRate),
+	             static_cast<double>(MAX_ROUTE_COST)));
+	const int delta = std::abs(cost - entry.cost);
+	if (delta <= COST_HYSTERESIS_MIN ||
+	    delta <= static_cast<int>(COST_HYSTERESIS * entry.cost)) {
+		return;
+	}
+	cout << "AH Client: Route cost for " << entry.prefix << " " << entry.cost
+	     << " -> " << cost << " (srtt " << entry.srttMs << "ms, loss "
+	     << entry.lossRate << ")" << endl;
+	entry.cost = cost;
+	// Registering an existing route again only updates its cost.
+	registerRoute(entry.prefix, entry.faceId, cost, false);
+	for (const auto &extra : entry.extraPrefixes) {
+		registerRoute(extra, entry.faceId, cost, false);
+	}
+	for (const auto &route : m_gossip_routes) {
+		if (route.second.via.equals(entry.prefix)) {
+			registerRoute(route.first, route.second.faceId,
+			              cost + ROUTE_HOP_COST *
+			                         static_cast<int>(route.second.hops - 1),
+			              false);
+		}
+	}
+}
+
+void AHClient::onNack(const Interest &interest, const lp::Nack &nack) {
+	std::cout << "AH Client: received Nack with reason " << nack.getReason()
 	          << " for interest " << interest << std::endl;
 }
 
@@ -671,72 +2091,81 @@ void AHClient::onTimeout(const Interest &interest) {
 	std::cout << "AH Client: Timeout " << interest << std::endl;
 }
 
-void AHClient::sendData(const Name &route_name, const int face_id, int count) {
+void AHClient::sendData(const Name &route_name, const int face_id,
+                        const int attempt) {
 	// Then send back our info.
 	Name prefix(route_name);
 	prefix.append("nd-info");
-	appendIpPort(prefix);
+	// Give them the address of our interface on their link.
+	const DBEntry *entry = findItem(route_name);
+	appendIpPort(prefix, entry == nullptr ? m_IP : localAddressFor(entry->ip));
 	prefix.appendNumber(m_prefix.size()).append(m_prefix).appendTimestamp();
 
 	std::cout << "AH Client: Sending my data to " << route_name << std::endl;
 	Interest interest(prefix);
-	interest.setInterestLifetime(INTEREST_LIFETIME);
+	interest.setInterestLifetime(
+	    time::milliseconds(m_timing.interestLifetimeMs));
 	interest.setMustBeFresh(true);
 	interest.setNonce(4);
 	interest.setCanBePrefix(false);
-
-	m_face.expressInterest(
+	setAnnouncementParameters(interest, false);
+
+	const auto sent = time::steady_clock::now();
+	auto on_failed = [this, route_name, face_id, attempt, sent] {
+		m_tracer->span("nd-info failed", traceTrack(route_name), sent, attempt);
+		onRttLoss(route_name);
+		if (findItem(route_name) == nullptr) {
+			// Removed meanwhile, nobody to tell.
+			return;
+		}
+		if (RetryPolicy::canRetry(RetryOp::ND_INFO, attempt)) {
+			const auto waiting = time::steady_clock::now();
+			pierOps(route_name).infoRetry = m_retry->schedule(
+			    RetryOp::ND_INFO, attempt,
+			    [this, route_name, face_id, attempt, waiting] {
+				    m_tracer->span("nd-info retry wait", traceTrack(route_name),
+				                  waiting, attempt + 1);
+				    sendData(route_name, face_id, attempt + 1);
+			    });
+			return;
+		}
+		cout << "Giving up on pier " << route_name << endl;
+		teardownPier(route_name);
+	};
+	auto handle = m_face.expressInterest(
 	    interest,
-	    [](const Interest &interest, const Data &data) {
+	    [this, route_name, sent, attempt](const Interest &interest,
+	                                      const Data &data) {
 		    std::cout << "AH Client: Record Updated/Confirmed from "
 		              << data.getName() << std::endl;
+		    m_tracer->span("nd-info", traceTrack(route_name), sent, attempt);
+		    onRttSample(route_name, time::steady_clock::now() - sent);
+		    DBEntry *entry = findItem(route_name);
+		    if (entry != nullptr) {
+			    entry->infoPending = false;
+		    }
 	    },
-	    //[this, route_name, faceId, count](const Interest &interest,
-	    [=](const Interest &interest, const lp::Nack &nack) {
+	    [on_failed](const Interest &interest, const lp::Nack &nack) {
 		    std::cout << "AH Client: Received Nack with reason "
 		              << nack.getReason() << " for interest " << interest
 		              << std::endl;
-		    if (count < 4) {
-			    m_scheduler->schedule(time::seconds(3 * count),
-			                          [this, route_name, face_id, count] {
-				                          sendData(route_name, face_id,
-				                                   count + 1);
-			                          });
-		    } else {
-			    cout << "Giving up on pier " << route_name << endl;
-			    if (face_id > 0) {
-				    removeItem(route_name);
-				    cout << "Removing face and route for " << route_name
-				         << endl;
-				    removeRouteAndFace(route_name, face_id);
-			    }
-		    }
+		    on_failed();
 	    },
-	    [=](const Interest &interest) {
+	    [on_failed](const Interest &interest) {
 		    std::cout << "AH Client: Received timeout for interest " << interest
 		              << std::endl;
-		    if (count < 4) {
-			    m_scheduler->schedule(time::seconds(3 * count),
-			                          [this, route_name, face_id, count] {
-				                          sendData(route_name, face_id,
-				                                   count + 1);
-			                          });
-		    } else {
-			    cout << "Giving up on pier " << route_name << endl;
-			    if (face_id > 0) {
-				    removeItem(route_name);
-				    cout << "Removing face and route for " << route_name
-				         << endl;
-				    removeRouteAndFace(route_name, face_id);
-			    }
-		    }
+		    on_failed();
 	    });
+	if (findItem(route_name) != nullptr) {
+		pierOps(route_name).info = handle;
+	}
 }
 
 void AHClient::onRegisterRouteDataReply(const Interest &interest,
                                         const Data &data,
                                         const Name &route_name, int face_id,
-                                        int cost, const bool send_data) {
+                                        int cost, const bool send_data,
+                                        const int attempt) {
 	Block response_block = data.getContent().blockFromValue();
 	response_block.parse();
 
@@ -774,22 +2203,36 @@ void AHClient::onRegisterRouteDataReply(const Interest &interest,
 		std::cout << "Origin: " << origin << std::endl;
 		std::cout << "Route cost: " << route_cost << std::endl;
 		std::cout << "Flags: " << flags << std::endl;
+		if (m_events.routeReady && !isProbeName(route_name)) {
+			m_events.routeReady(route_name, face_id, cost);
+		}
+		DBEntry *entry = findItem(route_name);
+		if (isPendingRoute(route_name, face_id)) {
+			confirmPier(*entry);
+		}
 		if (send_data) {
-			sendData(route_name, face_id);
+			requestInfo(route_name);
 		}
 	} else {
 		std::cout << "\nRegistration of route failed." << std::endl;
 		std::cout << "Status text: " << response_text.data() << std::endl;
-		m_scheduler->schedule(
-		    time::seconds(3), [this, route_name, face_id, cost, send_data] {
-			    registerRoute(route_name, face_id, cost, send_data);
-		    });
+		retryRoute(route_name, face_id, cost, send_data, attempt);
 	}
 }
 
 void AHClient::onAddFaceDataReply(const Interest &interest, const Data &data,
                                   const string &uri, const Name &prefix,
-                                  DBEntry &entry, const bool send_data) {
+                                  const bool send_data, const int attempt) {
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr) {
+		// Removed while the command was on its way, its cancellation did not
+		// make it to NFD in time.
+		const int face_id = faceIdFromResponse(data);
+		if (face_id > 0) {
+			destroyFace(face_id);
+		}
+		return;
+	}
 	short response_code = 0;
 	std::array<char, BUF_SIZE> response_text{0};
 	response_text.fill(0);
@@ -814,15 +2257,21 @@ void AHClient::onAddFaceDataReply(const Interest &interest, const Data &data,
 		          << ": Added Face (FaceId: " << face_id << "): " << uri
 		          << std::endl;
 
-		entry.faceId = face_id;
-		registerRoute(prefix, face_id, 0, send_data);
+		if (response_code == FACE_EXISTS) {
+			// Created by someone else (or the pier's NFD reached us first),
+			// it has the NFD defaults.
+			updateFace(face_id, faceProfile(*entry));
+		}
+		entry->faceId = face_id;
+		setState(*entry, PierState::ROUTE_PENDING);
+		registerRoute(prefix, face_id, entry->cost, send_data);
+		for (const auto &extra : entry->extraPrefixes) {
+			registerRoute(extra, face_id, entry->cost, false);
+		}
 	} else {
 		std::cout << "\nCreation of face failed." << std::endl;
 		std::cout << "Status text: " << response_text.data() << std::endl;
-		m_scheduler->schedule(
-		    time::seconds(3), [this, uri, prefix, &entry, send_data] {
-			    addFaceAndPrefix(uri, prefix, entry, send_data);
-		    });
+		retryFace(uri, prefix, send_data, attempt);
 	}
 }
 
@@ -846,41 +2295,369 @@ void AHClient::onDestroyFaceDataReply(const Interest &interest,
 }
 
 void AHClient::addFaceAndPrefix(const string &uri, Name const &prefix,
-                                DBEntry &entry, const bool send_data) {
-	cout << "AH Client: Adding face: " << uri << endl;
-	Interest interest = prepareFaceCreationInterest(uri, m_keyChain);
-	m_face.expressInterest(
+                                const bool send_data, const int attempt) {
+	// Looked up by prefix every time, a DBEntry reference would not survive
+	// the pier being removed (or m_db growing) while a retry waits.
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr ||
+	    (attempt == 0 && entry->state == PierState::FACE_PENDING)) {
+		// Gone, or already on its way.
+		return;
+	}
+	setState(*entry, PierState::FACE_PENDING);
+	cout << "AH Client: Adding face: " << uri << " ("
+	     << linkClassName(entry->link) << ")" << endl;
+	Interest interest =
+	    prepareFaceCreationInterest(uri, "", faceProfile(*entry), m_keyChain);
+	const auto sent = time::steady_clock::now();
+	pierOps(prefix).command = expressCommand(
 	    interest,
-	    [this, uri, prefix, &entry, send_data](auto &&interest, auto &&data) {
-		    onAddFaceDataReply(interest, data, uri, prefix, entry, send_data);
+	    [this, uri, prefix, send_data, attempt, sent](auto &&interest,
+	                                                  auto &&data) {
+		    m_tracer->span("faces/create", traceTrack(prefix), sent, attempt);
+		    onAddFaceDataReply(interest, data, uri, prefix, send_data,
+		                       attempt);
 	    },
-	    [this, uri, prefix, &entry, send_data](const Interest &interest,
-	                                           const lp::Nack &nack) {
+	    [this, uri, prefix, send_data, attempt, sent](const Interest &interest,
+	                                                  const lp::Nack &nack) {
 		    std::cout << "AH Client: Received Nack with reason "
 		              << nack.getReason() << " for interest " << interest
 		              << std::endl;
-		    m_scheduler->schedule(
-		        time::seconds(3), [this, uri, prefix, &entry, send_data] {
-			        addFaceAndPrefix(uri, prefix, entry, send_data);
-		        });
+		    m_tracer->span("faces/create failed", traceTrack(prefix), sent,
+		                  attempt);
+		    retryFace(uri, prefix, send_data, attempt);
 	    },
-	    [this, uri, prefix, &entry, send_data](const Interest &interest) {
+	    [this, uri, prefix, send_data, attempt,
+	     sent](const Interest &interest) {
 		    std::cout << "AH Client: Received timeout when adding face "
 		              << interest << std::endl;
-		    m_scheduler->schedule(
-		        time::seconds(3), [this, uri, prefix, &entry, send_data] {
-			        addFaceAndPrefix(uri, prefix, entry, send_data);
-		        });
+		    m_tracer->span("faces/create failed", traceTrack(prefix), sent,
+		                  attempt);
+		    retryFace(uri, prefix, send_data, attempt);
+	    });
+}
+
+void AHClient::retryFace(const string &uri, const Name &prefix,
+                         const bool send_data, const int attempt) {
+	if (findItem(prefix) == nullptr) {
+		return;
+	}
+	if (!RetryPolicy::canRetry(RetryOp::FACE, attempt)) {
+		// Forget the pier, its next announcement starts over.
+		cout << "AH Client: Giving up on face " << uri << " for " << prefix
+		     << endl;
+		teardownPier(prefix);
+		return;
+	}
+	const auto waiting = time::steady_clock::now();
+	pierOps(prefix).commandRetry = m_retry->schedule(
+	    RetryOp::FACE, attempt,
+	    [this, uri, prefix, send_data, attempt, waiting] {
+		    m_tracer->span("face retry wait", traceTrack(prefix), waiting,
+		                  attempt + 1);
+		    addFaceAndPrefix(uri, prefix, send_data, attempt + 1);
 	    });
 }
 
+void AHClient::updateExtraPrefixes(DBEntry &entry,
+                                   const std::vector<Name> &extra_prefixes) {
+	if (entry.extraPrefixes == extra_prefixes) {
+		return;
+	}
+	// If the face is still being created the new set is registered once it
+	// is up (onAddFaceDataReply).
+	if (entry.faceId > 0) {
+		for (const auto &extra : extra_prefixes) {
+			if (std::find(entry.extraPrefixes.begin(), entry.extraPrefixes.end(),
+			              extra) == entry.extraPrefixes.end()) {
+				registerRoute(extra, entry.faceId, entry.cost, false);
+			}
+		}
+		for (const auto &extra : entry.extraPrefixes) {
+			if (std::find(extra_prefixes.begin(), extra_prefixes.end(),
+			              extra) == extra_prefixes.end()) {
+				removeRoute(extra, entry.faceId);
+			}
+		}
+	}
+	entry.extraPrefixes = extra_prefixes;
+}
+
+void AHClient::removeRoute(const Name &prefix, const int faceId) {
+	std::cout << "AH Client: Removing route " << prefix << " from face "
+	          << faceId << endl;
+	auto unreg_interest =
+	    prepareRibUnregisterInterest(prefix, faceId, m_keyChain);
+	expressCommand(
+	    unreg_interest, [](const Interest &interest, const Data &data) {},
+	    [](auto &&interest, auto &&nack) { onNack(interest, nack); },
+	    [](auto &&interest) { onTimeout(interest); });
+}
+
+void AHClient::raceAddresses(const Name &prefix) {
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr || entry->state != PierState::CONFIRMED ||
+	    entry->raceFaceId != 0 || !entry->mac.empty() || !entry->hasIp6 ||
+	    entry->ip.s_addr == 0 || !m_has_ip6 || m_IP.s_addr == 0) {
+		return;
+	}
+	const bool race_ip6 = !entry->useIp6;
+	const std::string uri = race_ip6 ? udpUri(entry->ip6, entry->port)
+	                                 : udpUri(entry->ip, entry->port);
+	cout << "AH Client: Racing " << prefix << " over " << uri << endl;
+	// Face is being created.
+	entry->raceFaceId = -1;
+	auto failed = [this, prefix] {
+		DBEntry *entry = findItem(prefix);
+		if (entry != nullptr) {
+			entry->raceFaceId = 0;
+		}
+	};
+	Interest interest =
+	    prepareFaceCreationInterest(uri, "", faceProfile(*entry), m_keyChain);
+	expressCommand(
+	    interest,
+	    [this, prefix, race_ip6, failed](const Interest &interest,
+	                                     const Data &data) {
+		    const int face_id = faceIdFromResponse(data);
+		    DBEntry *entry = findItem(prefix);
+		    if (entry == nullptr || entry->raceFaceId != -1 || face_id <= 0) {
+			    cout << "AH Client: Not racing " << prefix << endl;
+			    if (entry == nullptr && face_id > 0) {
+				    destroyFace(face_id);
+			    }
+			    failed();
+			    return;
+		    }
+		    entry->raceFaceId = face_id;
+		    entry->raceProbes = 2 * RACE_PROBES;
+		    entry->race4Ms = 0;
+		    entry->race6Ms = 0;
+		    // Pin a probe name to each face so a probe can not take the
+		    // other path.
+		    registerRoute(probeName(prefix, race_ip6), face_id, 0, false);
+		    registerRoute(probeName(prefix, !race_ip6), entry->faceId, 0,
+		                  false);
+		    for (int i = 0; i < RACE_PROBES; i++) {
+			    m_scheduler->schedule(
+			        time::milliseconds(RACE_SETTLE_MS +
+			                           i * RACE_PROBE_SPACING_MS),
+			        [this, prefix] {
+				        sendAddressProbe(prefix, false);
+				        sendAddressProbe(prefix, true);
+			        });
+		    }
+	    },
+	    [failed](const Interest &interest, const lp::Nack &nack) {
+		    onNack(interest, nack);
+		    failed();
+	    },
+	    [failed](const Interest &interest) {
+		    onTimeout(interest);
+		    failed();
+	    });
+}
+
+void AHClient::sendAddressProbe(const Name &prefix, const bool ip6) {
+	Name name = probeName(prefix, ip6);
+	name.appendTimestamp();
+	Interest interest(name);
+	interest.setInterestLifetime(RACE_PROBE_LIFETIME);
+	interest.setMustBeFresh(true);
+	interest.setCanBePrefix(false);
+	const auto sent = time::steady_clock::now();
+	m_face.expressInterest(
+	    interest,
+	    [this, prefix, ip6, sent](const Interest &interest, const Data &data) {
+		    DBEntry *entry = findItem(prefix);
+		    if (entry != nullptr && entry->raceProbes > 0) {
+			    const double ms =
+			        static_cast<double>(
+			            time::duration_cast<time::microseconds>(
+			                time::steady_clock::now() - sent)
+			                .count()) /
+			        1000.0;
+			    double &best = ip6 ? entry->race6Ms : entry->race4Ms;
+			    if (best == 0 || ms < best) {
+				    best = ms;
+			    }
+		    }
+		    onAddressProbeDone(prefix);
+	    },
+	    [this, prefix](const Interest &interest, const lp::Nack &nack) {
+		    onAddressProbeDone(prefix);
+	    },
+	    [this, prefix](const Interest &interest) {
+		    onAddressProbeDone(prefix);
+	    });
+}
+
+void AHClient::onAddressProbeDone(const Name &prefix) {
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr || entry->raceProbes <= 0) {
+		return;
+	}
+	entry->raceProbes--;
+	if (entry->raceProbes == 0) {
+		finishAddressRace(*entry);
+	}
+}
+
+void AHClient::finishAddressRace(DBEntry &entry) {
+	const double current = entry.useIp6 ? entry.race6Ms : entry.race4Ms;
+	const double other = entry.useIp6 ? entry.race4Ms : entry.race6Ms;
+	const int race_face = entry.raceFaceId;
+	entry.raceFaceId = 0;
+	cout << "AH Client: " << entry.prefix << " udp4 " << entry.race4Ms
+	     << "ms, udp6 " << entry.race6Ms << "ms" << endl;
+	// Stay put unless the other family is clearly faster or the current one
+	// did not answer at all.
+	if (other <= 0 || (current > 0 && other >= current * RACE_MARGIN)) {
+		removeRoute(probeName(entry.prefix, entry.useIp6), entry.faceId);
+		destroyFace(race_face);
+		return;
+	}
+	entry.useIp6 = !entry.useIp6;
+	entry.srttMs = other;
+	entry.rttSamples = 1;
+	entry.lossRate = 0;
+	cout << "AH Client: Switching " << entry.prefix << " to "
+	     << (entry.useIp6 ? "udp6" : "udp4") << " face " << race_face << endl;
+	removeRoute(probeName(entry.prefix, entry.useIp6), race_face);
+	switchFace(entry, race_face);
+}
+
+void AHClient::tryEtherFace(const Name &prefix) {
+	DBEntry *entry = findItem(prefix);
+	if (entry == nullptr || entry->state != PierState::CONFIRMED ||
+	    !entry->mac.empty() || entry->useIp6) {
+		return;
+	}
+	const Interface *iface = interfaceFor(entry->ip);
+	const std::string mac =
+	    iface == nullptr ? "" : arpLookup(entry->ip, iface->name);
+	if (mac.empty()) {
+		cout << "AH Client: No MAC for " << prefix << ", staying on UDP"
+		     << endl;
+		raceAddresses(prefix);
+		return;
+	}
+	const std::string uri = "ether://[" + mac + "]";
+	const std::string local_uri = "dev://" + iface->name;
+	cout << "AH Client: Adding face: " << uri << " on " << local_uri << endl;
+	// Ethernet faces can not be on-demand and take no MTU override.
+	FaceProfile profile = m_face_profiles[LinkClass::ETHER];
+	profile.persistency = PERSISTENCY_PERSISTENT;
+	profile.mtu = 0;
+	if (entry->lossy) {
+		profile.lpReliability = true;
+	}
+	Interest interest =
+	    prepareFaceCreationInterest(uri, local_uri, profile, m_keyChain);
+	expressCommand(
+	    interest,
+	    [this, prefix, mac](const Interest &interest, const Data &data) {
+		    const int face_id = faceIdFromResponse(data);
+		    DBEntry *entry = findItem(prefix);
+		    if (face_id <= 0) {
+			    // NFD may have no Ethernet support, UDP still works.
+			    cout << "AH Client: Ethernet face failed for " << prefix
+			         << endl;
+			    raceAddresses(prefix);
+			    return;
+		    }
+		    if (entry == nullptr || entry->faceId <= 0) {
+			    // Gone (or lost its face) while this was in flight, the
+			    // persistent face would stay in NFD for good.
+			    destroyFace(face_id);
+			    return;
+		    }
+		    if (entry->faceId == face_id) {
+			    return;
+		    }
+		    entry->mac = mac;
+		    entry->link = LinkClass::ETHER;
+		    switchFace(*entry, face_id);
+	    },
+	    [this, prefix](const Interest &interest, const lp::Nack &nack) {
+		    onNack(interest, nack);
+		    raceAddresses(prefix);
+	    },
+	    [this, prefix](const Interest &interest) {
+		    onTimeout(interest);
+		    raceAddresses(prefix);
+	    });
+}
+
+auto AHClient::udpLinkClass(const in_addr &ip) -> LinkClass {
+	const Interface *iface = interfaceFor(ip);
+	if (iface == nullptr) {
+		// Not on one of our subnets (or IPv6 only).
+		return LinkClass::WAN;
+	}
+	return iface->wireless ? LinkClass::WIRELESS : LinkClass::LAN;
+}
+
+auto AHClient::faceProfile(const DBEntry &entry) -> FaceProfile {
+	FaceProfile profile = m_face_profiles[entry.link];
+	if (entry.lossy) {
+		profile.lpReliability = true;
+	}
+	return profile;
+}
+
+void AHClient::adjustFaceProfile(DBEntry &entry) {
+	const bool lossy = entry.lossy ? entry.lossRate > LOSSY_LOSS_RATE / 2
+	                               : entry.lossRate > LOSSY_LOSS_RATE;
+	if (lossy == entry.lossy) {
+		return;
+	}
+	entry.lossy = lossy;
+	if (entry.faceId <= 0 || m_face_profiles[entry.link].lpReliability) {
+		// Nothing to change on the face.
+		return;
+	}
+	cout << "AH Client: Loss " << entry.lossRate << " on " << entry.prefix
+	     << ", LP reliability " << (lossy ? "on" : "off") << endl;
+	updateFace(entry.faceId, faceProfile(entry));
+}
+
+void AHClient::updateFace(const int face_id, const FaceProfile &profile) {
+	Interest interest = prepareFaceUpdateInterest(face_id, profile, m_keyChain);
+	expressCommand(
+	    interest,
+	    [face_id](const Interest &interest, const Data &data) {
+		    Block response = data.getContent().blockFromValue();
+		    response.parse();
+		    cout << "AH Client: Updated face " << face_id << ": "
+		         << readNonNegativeInteger(response.get(STATUS_CODE)) << endl;
+	    },
+	    [](const Interest &interest, const lp::Nack &nack) {
+		    onNack(interest, nack);
+	    },
+	    [](const Interest &interest) { onTimeout(interest); });
+}
+
+void AHClient::switchFace(DBEntry &entry, const int face_id) {
+	const int old_face = entry.faceId;
+	entry.faceId = face_id;
+	registerRoute(entry.prefix, face_id, entry.cost, false);
+	for (const auto &extra : entry.extraPrefixes) {
+		registerRoute(extra, face_id, entry.cost, false);
+	}
+	// Gossiped routes go with the old face, pull the full list again.
+	m_gossip_seen.erase(entry.prefix);
+	m_gossip_pulls.erase(entry.prefix);
+	destroyFace(old_face);
+}
+
 void AHClient::removeRouteAndFace(const Name &prefix, const int faceId) {
 	// Shutdown route/face.
 	std::cout << "AH Client: Removing route " << prefix << " and face "
 	          << faceId << endl;
 	auto unreg_interest =
 	    prepareRibUnregisterInterest(prefix, faceId, m_keyChain);
-	m_face.expressInterest(
+	expressCommand(
 	    unreg_interest,
 	    [faceId, this](const Interest &interest, const Data &data) {
 		    destroyFace(faceId);
@@ -892,7 +2669,7 @@ void AHClient::removeRouteAndFace(const Name &prefix, const int faceId) {
 void AHClient::destroyFace(int face_id) {
 	if (face_id > 0) {
 		Interest interest = prepareFaceDestroyInterest(face_id, m_keyChain);
-		m_face.expressInterest(
+		expressCommand(
 		    interest,
 		    [face_id](auto &&interest, auto &&data) {
 			    onDestroyFaceDataReply(interest, data, face_id);
@@ -905,51 +2682,314 @@ void AHClient::destroyFace(int face_id) {
 	}
 }
 
+static auto isWireless(const std::string &ifname) -> bool {
+	return access(("/sys/class/net/" + ifname + "/wireless").c_str(), F_OK) ==
+	       0;
+}
+
+// Rank an interface by its link speed (Mbps) as reported by the kernel, when
+// the driver does not report one assume a slow wireless or fast ethernet link.
+static auto linkRank(const std::string &ifname) -> long {
+	long speed = 0;
+	std::ifstream speed_file("/sys/class/net/" + ifname + "/speed");
+	if (!(speed_file >> speed) || speed <= 0) {
+		speed = isWireless(ifname) ? DEFAULT_WIRELESS_MBPS : DEFAULT_WIRED_MBPS;
+	}
+	return speed;
+}
+
 void AHClient::setIP() {
 	// This will have NOLINTS because it is using a C api and will be doing
 	// unsafe stuff.
 	struct ifaddrs *ifaddr = nullptr;
 	struct ifaddrs *ifa = nullptr;
-	int s = 0;
-	bool found = false;
-	std::array<char, NI_MAXHOST> host{};
-	host.fill(0);
+	std::vector<Interface> interfaces;
 	if (getifaddrs(&ifaddr) == -1) {
 		perror("getifaddrs");
 		exit(EXIT_FAILURE);
 	}
 
 	for (ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-		if (ifa->ifa_addr == nullptr) {
+		if (ifa->ifa_addr == nullptr || ifa->ifa_netmask == nullptr ||
+		    ifa->ifa_addr->sa_family != AF_INET ||
+		    (ifa->ifa_flags & IFF_UP) == 0 ||
+		    (ifa->ifa_flags & IFF_RUNNING) == 0 ||
+		    (ifa->ifa_flags & IFF_LOOPBACK) != 0) {
 			continue;
 		}
+		Interface iface;
+		iface.name = ifa->ifa_name;
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		iface.addr = reinterpret_cast<sockaddr_in *>(ifa->ifa_addr)->sin_addr;
+		iface.netmask =
+		    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		    reinterpret_cast<sockaddr_in *>(ifa->ifa_netmask)->sin_addr;
+		iface.rank = linkRank(iface.name);
+		iface.wireless = isWireless(iface.name);
+		cout << "\tInterface : <" << iface.name << ">" << endl;
+		cout << "\t  Address : <" << inet_ntoa(iface.addr) << ">" << endl;
+		cout << "\t  Rank    : <" << iface.rank << ">" << endl;
+		interfaces.push_back(iface);
+	}
+	for (ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+		if (ifa->ifa_addr == nullptr || ifa->ifa_addr->sa_family != AF_INET6 ||
+		    (ifa->ifa_flags & IFF_UP) == 0 ||
+		    (ifa->ifa_flags & IFF_RUNNING) == 0 ||
+		    (ifa->ifa_flags & IFF_LOOPBACK) != 0) {
+			continue;
+		}
+		const in6_addr &addr6 =
+		    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+		    reinterpret_cast<sockaddr_in6 *>(ifa->ifa_addr)->sin6_addr;
+		// Link local addresses need a scope in the face URI, only use
+		// routable ones.
+		if (IN6_IS_ADDR_LINKLOCAL(&addr6) || IN6_IS_ADDR_MULTICAST(&addr6)) {
+			continue;
+		}
+		auto iface = std::find_if(
+		    interfaces.begin(), interfaces.end(),
+		    [ifa](const Interface &i) { return i.name == ifa->ifa_name; });
+		if (iface == interfaces.end()) {
+			Interface v6_only;
+			v6_only.name = ifa->ifa_name;
+			v6_only.rank = linkRank(v6_only.name);
+			v6_only.wireless = isWireless(v6_only.name);
+			interfaces.push_back(v6_only);
+			iface = std::prev(interfaces.end());
+		}
+		if (!iface->hasAddr6) {
+			iface->addr6 = addr6;
+			if (ifa->ifa_netmask != nullptr) {
+				// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+				auto *mask = reinterpret_cast<sockaddr_in6 *>(ifa->ifa_netmask);
+				iface->netmask6 = mask->sin6_addr;
+			}
+			iface->hasAddr6 = true;
+			cout << "\tInterface : <" << iface->name << ">" << endl;
+			cout << "\t  IPv6    : <" << ip6String(addr6) << ">" << endl;
+		}
+	}
+	freeifaddrs(ifaddr);
+	m_IP.s_addr = 0;
+	m_has_ip6 = false;
+	if (interfaces.empty()) {
+		cout << "AH Client: Could not find host ip, waiting for one." << endl;
+		m_interfaces.clear();
+		return;
+	}
+	// The best link of each family is our primary address.
+	long best4 = -1;
+	long best6 = -1;
+	for (const auto &iface : interfaces) {
+		if (iface.addr.s_addr != 0 && iface.rank > best4) {
+			best4 = iface.rank;
+			m_IP = iface.addr;
+		}
+		if (iface.hasAddr6 && iface.rank > best6) {
+			best6 = iface.rank;
+			m_IP6 = iface.addr6;
+			m_has_ip6 = true;
+		}
+	}
+	m_interfaces = std::move(interfaces);
+}
+
+void AHClient::scheduleInterfaceRefresh() {
+	m_interface_refresh.cancel();
+	m_interface_refresh =
+	    m_scheduler->schedule(time::milliseconds(INTERFACE_SETTLE_MS),
+	                          [this] { refreshInterfaces(); });
+}
 
-		s = getnameinfo(ifa->ifa_addr, sizeof(struct sockaddr_in), host.data(),
-		                NI_MAXHOST, nullptr, 0, NI_NUMERICHOST);
-		if (s != 0) {
+void AHClient::refreshInterfaces() {
+	const std::vector<Interface> old_interfaces = m_interfaces;
+	const in_addr old_ip = m_IP;
+	setIP();
+	auto same = [](const Interface &a, const Interface &b) {
+		return a.name == b.name && a.addr.s_addr == b.addr.s_addr &&
+		       a.netmask.s_addr == b.netmask.s_addr &&
+		       a.hasAddr6 == b.hasAddr6 &&
+		       memcmp(&a.addr6, &b.addr6, sizeof(a.addr6)) == 0;
+	};
+	std::vector<Interface> lost;
+	for (const auto &old_iface : old_interfaces) {
+		if (std::none_of(m_interfaces.begin(), m_interfaces.end(),
+		                 [&](const Interface &i) { return same(i, old_iface); })) {
+			lost.push_back(old_iface);
+		}
+	}
+	const bool gained = std::any_of(
+	    m_interfaces.begin(), m_interfaces.end(), [&](const Interface &i) {
+		    return std::none_of(
+		        old_interfaces.begin(), old_interfaces.end(),
+		        [&](const Interface &o) { return same(i, o); });
+	    });
+	if (lost.empty() && !gained && old_ip.s_addr == m_IP.s_addr) {
+		return;
+	}
+	cout << "AH Client: Interfaces changed, primary address now "
+	     << inet_ntoa(m_IP) << endl;
+	if (!lost.empty()) {
+		retirePiers(lost);
+	}
+	if (!m_interfaces.empty()) {
+		sendArrivalInterest();
+		// NFD creates multicast faces for new interfaces on its own schedule,
+		// announce again once it has likely caught up.
+		m_scheduler->schedule(time::seconds(REANNOUNCE_SECONDS),
+		                      [this] { sendArrivalInterest(); });
+	}
+}
+
+void AHClient::retirePiers(const std::vector<Interface> &lost) {
+	for (auto &item : m_db) {
+		if (item.prefix.empty()) {
 			continue;
 		}
+		// Match on the address the pier's face was created with.
+		bool reachable = false;
+		bool on_lost = false;
+		if (item.useIp6) {
+			reachable = interfaceFor(item.ip6) != nullptr;
+			on_lost = std::any_of(
+			    lost.begin(), lost.end(), [&item](const Interface &iface) {
+				    return iface.hasAddr6 &&
+				           sameSubnet(iface.addr6, item.ip6, iface.netmask6);
+			    });
+		} else {
+			reachable = interfaceFor(item.ip) != nullptr;
+			on_lost = std::any_of(
+			    lost.begin(), lost.end(), [&item](const Interface &iface) {
+				    return iface.addr.s_addr != 0 &&
+				           (iface.addr.s_addr & iface.netmask.s_addr) ==
+				               (item.ip.s_addr & iface.netmask.s_addr);
+			    });
+		}
+		// Still reachable on one of our links, or never was on a lost one.
+		if (!reachable && on_lost) {
+			cout << "AH Client: Link lost, retiring " << item.prefix << endl;
+			teardownPier(Name(item.prefix));
+		}
+	}
+}
 
-		if (ifa->ifa_addr->sa_family == AF_INET) {
-			// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			if (ifa->ifa_name[0] == 'l' &&
-			    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-			    ifa->ifa_name[1] == 'o') {
-				// Loopback
-				continue;
+auto AHClient::interfaceFor(const in_addr &ip) -> const Interface * {
+	const Interface *found = nullptr;
+	for (const auto &iface : m_interfaces) {
+		if (iface.addr.s_addr != 0 &&
+		    (iface.addr.s_addr & iface.netmask.s_addr) ==
+		        (ip.s_addr & iface.netmask.s_addr) &&
+		    (found == nullptr || iface.rank > found->rank)) {
+			found = &iface;
+		}
+	}
+	return found;
+}
+
+auto AHClient::interfaceFor(const in6_addr &ip) -> const Interface * {
+	const Interface *found = nullptr;
+	for (const auto &iface : m_interfaces) {
+		if (iface.hasAddr6 && sameSubnet(iface.addr6, ip, iface.netmask6) &&
+		    (found == nullptr || iface.rank > found->rank)) {
+			found = &iface;
+		}
+	}
+	return found;
+}
+
+auto AHClient::localAddressFor(const in_addr &ip) -> in_addr {
+	const Interface *iface = interfaceFor(ip);
+	return iface == nullptr ? m_IP : iface->addr;
+}
+
+auto AHClient::isLocalAddress(const in_addr &ip) -> bool {
+	for (const auto &iface : m_interfaces) {
+		if (ip.s_addr != 0 && iface.addr.s_addr == ip.s_addr) {
+			return true;
+		}
+	}
+	return false;
+}
+
+auto AHClient::isLocalAddress(const in6_addr &ip) -> bool {
+	for (const auto &iface : m_interfaces) {
+		if (iface.hasAddr6 && memcmp(&iface.addr6, &ip, sizeof(ip)) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+auto AHClient::announcementFaces() -> std::vector<std::pair<uint64_t, in_addr>> {
+	std::vector<std::pair<uint64_t, in_addr>> targets;
+	if (m_interfaces.size() > 1) {
+		// Multicast face local URIs are udp4://<interface ip>:<port>,
+		// udp6://[<interface ip>]:<port> or dev://<interface name>.  An
+		// interface without IPv4 is announced with its IPv6 address.
+		for (const auto &face : m_multicast->faces()) {
+			const std::string &uri = face.getLocalUri();
+			in_addr addr = m_IP;
+			for (const auto &iface : m_interfaces) {
+				const std::string udp = string("udp4://") +
+				                        inet_ntoa(iface.addr) + ":";
+				const std::string udp6 =
+				    "udp6://[" + ip6String(iface.addr6) + "]:";
+				if ((iface.addr.s_addr != 0 &&
+				     uri.compare(0, udp.size(), udp) == 0) ||
+				    (iface.hasAddr6 &&
+				     uri.compare(0, udp6.size(), udp6) == 0) ||
+				    uri == "dev://" + iface.name) {
+					addr = iface.addr;
+					break;
+				}
 			}
-			cout << "\tInterface : <" << ifa->ifa_name << ">" << endl;
-			cout << "\t  Address : <" << host.data() << ">" << endl;
-			inet_aton(host.data(), &m_IP);
-			found = true;
-			break;
+			targets.emplace_back(face.getFaceId(), addr);
 		}
 	}
-	freeifaddrs(ifaddr);
-	if (!found) {
-		cout << "AH Client: Could not find host ip." << endl;
-		exit(1);
+	if (targets.empty()) {
+		// Let the multicast strategy send it everywhere.
+		targets.emplace_back(0, m_IP);
 	}
+	return targets;
+}
+
+void AHClient::movePier(DBEntry &entry, const in_addr &ip, uint16_t port,
+                        const std::string &uri) {
+	if ((entry.ip.s_addr == ip.s_addr && entry.port == port) ||
+	    entry.state != PierState::CONFIRMED || !entry.mac.empty()) {
+		// Same address, still provisioning or on an Ethernet face which
+		// does not care about addresses.
+		return;
+	}
+	const Interface *current = interfaceFor(entry.ip);
+	const Interface *offered = interfaceFor(ip);
+	// A new address on the same link means the pier was renumbered,
+	// otherwise only move to a better link.
+	if (offered == nullptr || (current != nullptr && current != offered &&
+	                           offered->rank <= current->rank)) {
+		return;
+	}
+	cout << "AH Client: Moving " << entry.prefix << " to " << uri << " on "
+	     << offered->name << endl;
+	// It is down until the new face and route are up, which reports it up
+	// again.
+	if (m_events.pierDown) {
+		m_events.pierDown(entry);
+	}
+	removeRouteAndFace(entry.prefix, entry.faceId);
+	entry.ip = ip;
+	entry.port = port;
+	entry.faceId = 0;
+	entry.cost = 0;
+	entry.srttMs = 0;
+	entry.rttSamples = 0;
+	entry.lossRate = 0;
+	addFaceAndPrefix(uri, entry.prefix, false);
+}
+
+void AHClient::getStatus(const StatusCallback &statusCallback,
+                         const StatusErrorCallback &errorCallback) {
+	m_statusinfo->getStatus(statusCallback, errorCallback);
 }
 
 void AHClient::getPierStatus(const long id,
@@ -972,7 +3012,8 @@ void AHClient::getPierStatus(const long id,
 			name.append("nd-status");
 			name.appendTimestamp();
 			Interest interest(name);
-			interest.setInterestLifetime(INTEREST_LIFETIME);
+			interest.setInterestLifetime(
+			    time::milliseconds(m_timing.interestLifetimeMs));
 			interest.setMustBeFresh(true);
 			interest.setNonce(4);
 			interest.setCanBePrefix(false);
@@ -1016,6 +3057,50 @@ void AHClient::getPierStatus(const long id,
 	}
 }
 
+void AHClient::benchPier(const long id, const BenchOptions &options,
+                         const BenchDoneCallback &doneCallback,
+                         const StatusErrorCallback &errorCallback) {
+	for (const auto &item : m_db) {
+		if (!item.prefix.empty() && item.faceId > 0 && item.id == id - 1) {
+			if (options.bytes > MAX_BENCH_BYTES) {
+				errorCallback("Benchmark size too large");
+				return;
+			}
+			cout << "AH Client: Benchmarking " << item.prefix << " with "
+			     << options.bytes << " bytes" << endl;
+			std::make_shared<BenchFetcher>(m_face, item.prefix, options,
+			                               doneCallback, errorCallback)
+			    ->start();
+			return;
+		}
+	}
+	errorCallback("Pier not found!");
+}
+
+void AHClient::pingPiers(const long id, PingOptions options,
+                         const PingDoneCallback &doneCallback,
+                         const StatusErrorCallback &errorCallback) {
+	std::vector<PingTarget> targets;
+	for (const auto &item : m_db) {
+		if (!item.prefix.empty() && item.faceId > 0 &&
+		    (id == 0 || item.id == id - 1)) {
+			targets.push_back({item.id + 1, item.prefix});
+		}
+	}
+	if (targets.empty()) {
+		errorCallback("Pier not found!");
+		return;
+	}
+	options.count = std::min(std::max(options.count, 1L), MAX_PING_COUNT);
+	options.intervalMs = std::max(options.intervalMs, 1L);
+	options.payloadSize = std::min(options.payloadSize, MAX_PING_PAYLOAD);
+	cout << "AH Client: Pinging " << targets.size() << " piers "
+	     << options.count << " times" << endl;
+	std::make_shared<Pinger>(m_face, *m_scheduler, std::move(targets), options,
+	                         doneCallback)
+	    ->start();
+}
+
 void AHClient::visitPiers(const VisitPiersCallback &callback) {
 	for (auto it = m_db.begin(); it != m_db.end();) {
 		if (!it->prefix.equals("")) {
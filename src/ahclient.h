@@ -1,64 +1,216 @@
 #ifndef AHND_AHCLIENT_H
 #define AHND_AHCLIENT_H
 
+#include <deque>
 #include <netinet/in.h>
 
-#include "multicast.h"
-#include "statusinfo.h"
+#include "config.h"
+#include "events.h"
+#include "faceprofile.h"
 
 namespace ahnd {
 
-struct DBEntry {
-	const long id;
-	struct in_addr ip {
-		0
-	};
-	uint16_t port;
-	ndn::Name prefix;
+class Admission;
+class Election;
+class LoadStats;
+class MulticastInterest;
+class NetlinkMonitor;
+class RetryPolicy;
+class StatusInfo;
+class Tracer;
+class WorkerPool;
+struct PierCounts;
+class DataTemplate;
+struct PierListEntry;
+
+// Outstanding work for one pier.  Each slot holds at most one interest or
+// timer (a new one cancels what it replaces) and dropping the whole thing,
+// as removing the pier does, cancels everything still pending for it.
+struct PierOps {
+	// faces/create or the rib/register of the pier's prefix, and its retry.
+	ndn::ScopedPendingInterestHandle command;
+	ndn::scheduler::ScopedEventId commandRetry;
+	// Our nd-info and its retry.
+	ndn::ScopedPendingInterestHandle info;
+	ndn::scheduler::ScopedEventId infoRetry;
+	ndn::ScopedPendingInterestHandle keepalive;
+	ndn::scheduler::ScopedEventId suspectProbe;
+	ndn::scheduler::ScopedEventId etherLookup;
+};
+
+// A prefix learned by gossip, reached through a direct pier.
+struct GossipRoute {
+	ndn::Name via;
 	int faceId;
+	uint64_t hops;
+};
 
-	DBEntry() : id(count++) {
-		port = 0;
-		faceId = 0;
-	}
+// The list last sent to one requester and its version.  Split horizon gives
+// every requester its own list, so each has its own version.
+struct GossipView {
+	uint64_t version{0};
+	// Prefix and hop count of each entry.
+	std::vector<std::pair<ndn::Name, uint64_t>> entries;
+};
 
-  private:
-	// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
-	static long count;
+// A pier list being pulled from a pier page by page, applied once the last
+// page is in.
+struct GossipPull {
+	uint64_t version{0};
+	std::vector<std::pair<ndn::Name, uint64_t>> entries;
 };
 
-using VisitPiersCallback = std::function<void(const DBEntry &pier)>;
+// A new pier turned away while too many others were being set up, handled
+// again once one of them is done.
+struct DeferredAnnouncement {
+	ndn::Interest request;
+	bool sendBack;
+	ndn::Name prefix;
+	ndn::time::steady_clock::time_point received;
+};
+
+// A usable local interface, addr is 0 if it only has IPv6.
+struct Interface {
+	std::string name;
+	in_addr addr{0};
+	in_addr netmask{0};
+	// First routable (not link local) IPv6 address.
+	in6_addr addr6{};
+	in6_addr netmask6{};
+	bool hasAddr6{false};
+	// Link speed in Mbps, higher is better.
+	long rank{0};
+	bool wireless{false};
+};
 
 class AHClient {
   public:
-	AHClient(ndn::Name m_prefix, ndn::Name broadcast_prefix, int port);
+	// Standalone, the client owns its face and processEvents() drives it.
+	AHClient(ndn::Name m_prefix, ndn::Name broadcast_prefix, int port,
+	         const Timing &timing = Timing());
+	// Embedded in an application, all work happens on the face's
+	// io_service which the caller runs.  The face has to outlive the client
+	// and the client its outstanding interests, call shutdown() and let the
+	// io_service run a moment before destroying it.
+	AHClient(ndn::Face &face, ndn::Name m_prefix, ndn::Name broadcast_prefix,
+	         int port, const Timing &timing = Timing());
+	~AHClient();
+	AHClient(const AHClient &) = delete;
+	auto operator=(const AHClient &) -> AHClient & = delete;
+	void setPierEvents(PierEvents events) { m_events = std::move(events); }
 	void registerPrefixes() { registerClientPrefix(); }
+	// Advertise an additional prefix served by this node, call before
+	// registerPrefixes().
+	void addPrefix(const ndn::Name &prefix);
 	void processEvents(long timeout_ms);
+	// Takes effect for everything started from now on, replies built from
+	// templates pick up a new freshness right away.
+	void setTiming(const Timing &timing);
 	void sendKeepAliveInterest();
+	// Pull pier lists from a few piers and register routes to what they can
+	// reach.
+	void sendGossip();
 	auto face() -> ndn::Face & { return m_face; }
+	// Timers of the client, follows a VirtualClock when there is one.
+	auto scheduler() -> ndn::Scheduler & { return *m_scheduler; }
 	void shutdown();
 	void getStatus(const StatusCallback &statusCallback,
-	               const StatusErrorCallback &errorCallback) {
-		m_statusinfo->getStatus(statusCallback, errorCallback);
-	}
+	               const StatusErrorCallback &errorCallback);
 	void getPierStatus(long id, const StatusCallback &statusCallback,
 	                   const StatusErrorCallback &errorCallback);
 	void visitPiers(const VisitPiersCallback &callback);
+	// Fetch a synthetic object from a pier's nd-bench producer and report
+	// goodput, retransmissions and segment latency.
+	void benchPier(long id, const BenchOptions &options,
+	               const BenchDoneCallback &doneCallback,
+	               const StatusErrorCallback &errorCallback);
+	// Ping one pier (by id, 0 for all of them) and report RTT percentiles
+	// and loss.
+	void pingPiers(long id, PingOptions options,
+	               const PingDoneCallback &doneCallback,
+	               const StatusErrorCallback &errorCallback);
+	// Announcement handling, provisioning and NFD command backlog as JSON.
+	auto getStats() -> std::string;
+	void resetStats();
+	// Chrome trace JSON of recent provisioning spans.
+	auto getTrace() -> std::string;
+	void setTracing(bool enabled);
+	void clearTrace();
 	auto getIp() -> in_addr { return m_IP; }
+	auto getIp6() -> in6_addr { return m_IP6; }
+	// Reach piers on our own links over Ethernet faces instead of UDP.
+	void setEtherFaces(bool enabled) { m_ether_faces = enabled; }
+	// Let the client enable local fields (faces/update) on an application's
+	// face so announcements to one interface only go out there, otherwise
+	// they go out on every interface.  A face the client created itself
+	// always gets them.  Takes effect from the next keepalive round.
+	void setLocalFields(bool enabled);
+	// Keep faces to count elected delegates of the segment only (or to
+	// everyone while we are one) and learn the rest by gossip from them, 0
+	// goes back to the full mesh.  Needs gossip running.
+	void setDelegates(size_t count);
+	auto getElection() -> std::string;
+	// Replace the NFD face settings used for piers on a kind of link.
+	void setFaceProfile(LinkClass link, const FaceProfile &profile) {
+		m_face_profiles[link] = profile;
+	}
+	auto hasIp6() -> bool { return m_has_ip6; }
 	auto getPort() -> uint16_t { return m_port; }
 	auto getPrefix() -> ndn::Name { return m_prefix; }
+	auto getExtraPrefixes() -> const std::vector<ndn::Name> & {
+		return m_extra_prefixes;
+	}
 
   private:
+	AHClient(std::unique_ptr<ndn::Face> owned_face, ndn::Face *face,
+	         ndn::Name prefix, ndn::Name broadcast_prefix, int port,
+	         const Timing &timing);
+	// Send a command to NFD, counted in LoadStats.
+	auto expressCommand(const ndn::Interest &interest,
+	                    const ndn::DataCallback &on_data,
+	                    const ndn::NackCallback &on_nack,
+	                    const ndn::TimeoutCallback &on_timeout)
+	    -> ndn::PendingInterestHandle;
+	// Tracer track of a pier, 0 (the node) if it is not one.
+	auto traceTrack(const ndn::Name &prefix) -> long;
 	void appendIpPort(ndn::Name &name);
+	// Appends our IPv6 address instead if ip is 0 (no IPv4 on the link).
+	void appendIpPort(ndn::Name &name, const in_addr &ip);
+	// Add our extra prefixes and optionally the membership digest of known
+	// piers to an arrival or nd-info interest.
+	void setAnnouncementParameters(ndn::Interest &interest, bool with_digest);
 	auto newItem() -> DBEntry &;
+	auto findItem(const ndn::Name &name) -> DBEntry *;
+	auto pierCount() -> size_t;
+	// Piers announced but without their face and route yet.
+	auto provisioningCount() -> size_t;
+	// What a new pier announced from ip (or ip6) would join.
+	auto pierCounts(const in_addr &ip, const in6_addr &ip6, bool use_ip6)
+	    -> PierCounts;
+	// Remember a new pier's announcement while the pending cap is reached.
+	void deferAnnouncement(const ndn::Interest &request, bool send_back,
+	                       const ndn::Name &prefix);
+	// Handle deferred announcements, as far as the pending cap allows, once
+	// a pier is no longer being set up.
+	void readmitDeferred();
+	// Whether a pier gets a face of its own, always unless delegates are
+	// elected and neither it nor we are one.
+	auto wantsPier(const ndn::Name &prefix) -> bool;
+	// Drop piers no longer wanted and set up newly elected delegates.
+	void applyElection();
 	auto hasEntry(const ndn::Name &name) -> bool;
 	void removeItem(const ndn::Name &name);
 	void removeItem(const DBEntry &item);
-	void registerClientPrefix();
-	void registerKeepAlivePrefix();
-	void registerPingPrefix();
-	void registerStatusPrefix();
-	void registerArrivePrefix();
+	void registerClientPrefix(int attempt = 0);
+	void registerKeepAlivePrefix(int attempt = 0);
+	void registerPingPrefix(int attempt = 0);
+	// Ping reply with a requested payload size.
+	auto pingReply(size_t payload_size) -> const DataTemplate &;
+	void registerStatusPrefix(int attempt = 0);
+	void registerGossipPrefix(int attempt = 0);
+	void registerBenchPrefix(int attempt = 0);
+	void onBenchInterest(const ndn::Interest &request);
+	void registerArrivePrefix(int attempt = 0);
 	void sendArrivalInterestInternal();
 	void sendArrivalInterest();
 	void sendDepartureInterestInternal();
@@ -66,41 +218,167 @@ class AHClient {
 	// Handle direct or multicast interests that contain a single remotes face
 	// and route information.
 	void onArriveInterest(const ndn::Interest &request, bool send_back);
+	// Reply to a multicast arrival after a randomized backoff.
+	void scheduleArrivalReply(const ndn::Interest &request,
+	                          const ndn::Name &prefix);
+	void cancelArrivalReply(const ndn::Name &prefix);
 	void registerRoute(const ndn::Name &route_name, int face_id, int cost,
-	                   bool send_data);
+	                   bool send_data, int attempt = 0);
 	static void onNack(const ndn::Interest &interest,
 	                   const ndn::lp::Nack &nack);
 	static void onTimeout(const ndn::Interest &interest);
-	void sendData(const ndn::Name &route_name, int face_id, int count = 1);
+	void sendData(const ndn::Name &route_name, int face_id, int attempt = 0);
+	// Send our nd-info to a pier, at most one exchange at a time and only
+	// once its route is up.
+	void requestInfo(const ndn::Name &prefix);
+	void setState(DBEntry &entry, PierState state);
+	// Face and route are up, start what waited for that.
+	void confirmPier(DBEntry &entry);
+	void sendKeepAlive(const ndn::Name &prefix);
+	// A pier sent us a keepalive over its face.
+	void heardOn(uint64_t face_id);
+	// Keepalive round, faces is null if the counters are not wanted or
+	// could not be fetched and every pier is probed.
+	void probeIdlePiers(const std::vector<ndn::nfd::FaceStatus> *faces);
+	void onKeepAliveFailed(const ndn::Name &prefix);
+	// Remove a pier along with its route and face.
+	void teardownPier(const ndn::Name &prefix);
+	auto pierOps(const ndn::Name &prefix) -> PierOps &;
 	void onRegisterRouteDataReply(const ndn::Interest &interest,
 	                              const ndn::Data &data,
 	                              const ndn::Name &route_name, int face_id,
-	                              int cost, bool send_data);
+	                              int cost, bool send_data, int attempt);
+	// Whether this is the registration a route-pending pier waits for.
+	auto isPendingRoute(const ndn::Name &route_name, int face_id) -> bool;
+	// Retry a route registration or give up on it.
+	void retryRoute(const ndn::Name &route_name, int face_id, int cost,
+	                bool send_data, int attempt);
 	void onAddFaceDataReply(const ndn::Interest &interest,
 	                        const ndn::Data &data, const std::string &uri,
-	                        const ndn::Name &prefix, DBEntry &entry,
-	                        bool send_data);
+	                        const ndn::Name &prefix, bool send_data,
+	                        int attempt);
 	static void onDestroyFaceDataReply(const ndn::Interest &interest,
 	                                   const ndn::Data &data, int face_id);
 	void addFaceAndPrefix(const std::string &uri, ndn::Name const &prefix,
-	                      DBEntry &entry, bool send_data);
+	                      bool send_data, int attempt = 0);
+	// Retry a face creation or give up on the pier.
+	void retryFace(const std::string &uri, const ndn::Name &prefix,
+	               bool send_data, int attempt);
+	void updateExtraPrefixes(DBEntry &entry,
+	                         const std::vector<ndn::Name> &extra_prefixes);
+	void removeRoute(const ndn::Name &prefix, int faceId);
+	auto isDirectPrefix(const ndn::Name &name) -> bool;
+	auto gossipEntries(const ndn::Name &exclude_via)
+	    -> std::vector<PierListEntry>;
+	// Version of the list for requester, bumped when its content changed.
+	auto gossipVersion(const ndn::Name &requester,
+	                   const std::vector<PierListEntry> &entries) -> uint64_t;
+	void onGossipInterest(const ndn::Interest &request);
+	// Ask a pier for the page of its list at offset, of known_version when
+	// continuing a pull, the version we have otherwise.
+	void requestGossip(const ndn::Name &pier, uint64_t known_version,
+	                   uint64_t offset);
+	void onGossipData(const ndn::Name &pier, const ndn::Data &data);
+	void learnGossipRoute(const ndn::Name &prefix, uint64_t hops,
+	                      const ndn::Name &via, int face_id);
+	void expireGossipRoutes();
+	void onRttSample(const ndn::Name &pier, ndn::time::nanoseconds rtt);
+	void onRttLoss(const ndn::Name &pier);
+	void updateRouteCost(DBEntry &entry);
+	// Happy eyeballs for piers that announce both families: bring up a face
+	// on the other family, probe both and keep the faster one.
+	void raceAddresses(const ndn::Name &prefix);
+	void sendAddressProbe(const ndn::Name &prefix, bool ip6);
+	void onAddressProbeDone(const ndn::Name &prefix);
+	void finishAddressRace(DBEntry &entry);
+	// Replace a same link pier's UDP face with an ether:// face to the MAC
+	// the kernel resolved for it.
+	void tryEtherFace(const ndn::Name &prefix);
+	// Point the pier's routes at face_id and drop its old face.
+	void switchFace(DBEntry &entry, int face_id);
+	// Link class of a UDP face to ip.
+	auto udpLinkClass(const in_addr &ip) -> LinkClass;
+	auto faceProfile(const DBEntry &entry) -> FaceProfile;
+	// Turn LP reliability on or off as the measured loss crosses a
+	// threshold.
+	void adjustFaceProfile(DBEntry &entry);
+	void updateFace(int face_id, const FaceProfile &profile);
 	void removeRouteAndFace(const ndn::Name &prefix, int faceId);
 	void destroyFace(int face_id);
 	void setIP();
+	void scheduleInterfaceRefresh();
+	// Rescan interfaces, re-announce on a change and retire piers that were
+	// only reachable over a lost link.
+	void refreshInterfaces();
+	void retirePiers(const std::vector<Interface> &lost);
+	// The best ranked local interface on the same subnet as ip.
+	auto interfaceFor(const in_addr &ip) -> const Interface *;
+	auto interfaceFor(const in6_addr &ip) -> const Interface *;
+	auto localAddressFor(const in_addr &ip) -> in_addr;
+	auto isLocalAddress(const in_addr &ip) -> bool;
+	auto isLocalAddress(const in6_addr &ip) -> bool;
+	// Multicast face id (0 for any) and the address to announce on it.
+	auto announcementFaces() -> std::vector<std::pair<uint64_t, in_addr>>;
+	// Re-provision a pier that announced itself on a better link.
+	void movePier(DBEntry &entry, const in_addr &ip, uint16_t port,
+	              const std::string &uri);
 
-	ndn::Face m_face;
+	// Only set when the client made its own face.
+	std::unique_ptr<ndn::Face> m_owned_face;
+	ndn::Face &m_face;
 	ndn::KeyChain m_keyChain;
+	PierEvents m_events;
+	std::unique_ptr<LoadStats> m_stats;
+	std::unique_ptr<Tracer> m_tracer;
+	Timing m_timing;
+	std::unique_ptr<Admission> m_admission;
+	// Only set in delegate mode.
+	std::unique_ptr<Election> m_election;
+	// Responses that never change apart from the name.
+	struct Replies;
+	std::unique_ptr<Replies> m_replies;
 	std::shared_ptr<ndn::nfd::Controller> m_controller;
 	ndn::Name m_prefix;
+	std::vector<ndn::Name> m_extra_prefixes;
 	ndn::Name m_broadcast_prefix;
 	in_addr m_IP{0};
+	in6_addr m_IP6{};
+	bool m_has_ip6{false};
+	bool m_ether_faces{false};
+	std::map<LinkClass, FaceProfile> m_face_profiles;
+	std::vector<Interface> m_interfaces;
+	ndn::scheduler::EventId m_arrival_retry;
+	int m_arrival_attempt{0};
+	ndn::scheduler::EventId m_interface_refresh;
+	std::unique_ptr<ahnd::NetlinkMonitor> m_netlink;
 	std::unique_ptr<ndn::Scheduler> m_scheduler;
+	std::unique_ptr<ahnd::RetryPolicy> m_retry;
 	uint16_t m_port;
-	ndn::RegisteredPrefixHandle m_arrivePrefixId;
+	// Our interest filters, unregistered when the client goes away so a
+	// shared face does not call into it.
+	std::map<ndn::Name, ndn::ScopedRegisteredPrefixHandle> m_prefix_handles;
 	std::unique_ptr<ahnd::MulticastInterest> m_multicast;
+	// Declared ahead of its users so its threads are joined after them.
+	std::unique_ptr<ahnd::WorkerPool> m_workers;
 	std::unique_ptr<ahnd::StatusInfo> m_statusinfo;
 	std::vector<DBEntry> m_db;
+	// Keyed by pier prefix, erased with the pier.
+	std::map<ndn::Name, PierOps> m_pier_ops;
 	std::vector<long> m_db_free;
+	// Next pier's tracer track, 0 is the node.
+	long m_next_track{1};
+	std::map<ndn::Name, ndn::scheduler::EventId> m_pending_replies;
+	// Oldest first.
+	std::deque<DeferredAnnouncement> m_deferred;
+	ndn::scheduler::ScopedEventId m_readmit;
+	// Last version handed out, starts from the clock so a restarted node
+	// does not repeat versions its piers have already seen.
+	uint64_t m_gossip_version;
+	std::map<ndn::Name, GossipView> m_gossip_views;
+	size_t m_gossip_next{0};
+	std::map<ndn::Name, uint64_t> m_gossip_seen;
+	std::map<ndn::Name, GossipPull> m_gossip_pulls;
+	std::map<ndn::Name, GossipRoute> m_gossip_routes;
 };
 
 } // namespace ahnd
@@ -0,0 +1,22 @@
+#ifndef AHND_TLV_H
+#define AHND_TLV_H
+
+// TLV types carried in the application parameters of arrival and nd-info
+// interests and in the content of gossip replies.  These are in the
+// application specific range (128-252) so they can not collide with the NDN
+// packet format types.
+enum AHND_TLV_TYPE {
+	MEMBERSHIP_DIGEST = 0x80,
+	DIGEST_SEED = 0x81,
+	DIGEST_HASH_COUNT = 0x82,
+	DIGEST_BITS = 0x83,
+	PIER_LIST = 0x84,
+	PIER_LIST_VERSION = 0x85,
+	PIER_LIST_ENTRY = 0x86,
+	PIER_LIST_HOPS = 0x87,
+	ADDRESS_V6 = 0x88,
+	PIER_LIST_OFFSET = 0x89,
+	PIER_LIST_NEXT = 0x8a,
+};
+
+#endif // AHND_TLV_H
@@ -0,0 +1,168 @@
+#include "bench.h"
+#include "pinger.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+constexpr auto BENCH_LIFETIME = 2_s;
+constexpr int MAX_RETRIES = 8;
+constexpr double MIN_WINDOW = 1;
+constexpr double MAX_WINDOW = 1024;
+constexpr double US_PER_MS = 1000.0;
+constexpr double BYTES_PER_MBIT = 1000000.0 / 8.0;
+
+BenchFetcher::BenchFetcher(Face &face, Name prefix, BenchOptions options,
+                           BenchDoneCallback done, StatusErrorCallback error)
+    : m_face(face), m_prefix(std::move(prefix)), m_options(options),
+      m_done(std::move(done)), m_error(std::move(error)),
+      m_window(std::min(std::max(options.window, MIN_WINDOW), MAX_WINDOW)),
+      m_ssthresh(MAX_WINDOW) {
+	m_segments.resize((m_options.bytes + BENCH_SEGMENT_SIZE - 1) /
+	                  BENCH_SEGMENT_SIZE);
+}
+
+void BenchFetcher::start() {
+	m_start = time::steady_clock::now();
+	if (m_segments.empty()) {
+		finish();
+		return;
+	}
+	fill();
+}
+
+void BenchFetcher::fill() {
+	while (!m_finished && m_in_flight < static_cast<uint64_t>(m_window)) {
+		uint64_t seg = 0;
+		if (!m_retx.empty()) {
+			seg = m_retx.front();
+			m_retx.pop_front();
+		} else if (m_next < m_segments.size()) {
+			seg = m_next++;
+		} else {
+			break;
+		}
+		sendSegment(seg);
+	}
+}
+
+void BenchFetcher::sendSegment(uint64_t seg) {
+	Name name(m_prefix);
+	name.append("nd-bench").appendNumber(m_options.bytes).appendSegment(seg);
+	Interest interest(name);
+	interest.setInterestLifetime(BENCH_LIFETIME);
+	interest.setMustBeFresh(true);
+	interest.setCanBePrefix(false);
+	m_segments.at(seg).sent = time::steady_clock::now();
+	m_in_flight++;
+	auto self = shared_from_this();
+	m_face.expressInterest(
+	    interest,
+	    [self, seg](const Interest &interest, const Data &data) {
+		    self->onData(seg, data);
+	    },
+	    [self, seg](const Interest &interest, const lp::Nack &nack) {
+		    self->m_nacks++;
+		    self->onLoss(seg);
+	    },
+	    [self, seg](const Interest &interest) {
+		    self->m_timeouts++;
+		    self->onLoss(seg);
+	    });
+}
+
+void BenchFetcher::onData(uint64_t seg, const Data &data) {
+	m_in_flight--;
+	Segment &segment = m_segments.at(seg);
+	if (m_finished || segment.done) {
+		fill();
+		return;
+	}
+	segment.done = true;
+	m_received++;
+	// Latency of retransmitted segments is ambiguous, leave it out.
+	if (segment.retries == 0) {
+		m_latencies.push_back(
+		    static_cast<double>(time::duration_cast<time::microseconds>(
+		                            time::steady_clock::now() - segment.sent)
+		                            .count()) /
+		    US_PER_MS);
+	}
+	if (m_options.aimd) {
+		// Slow start then additive increase of one segment per window.
+		m_window += m_window < m_ssthresh ? 1.0 : 1.0 / m_window;
+		m_window = std::min(m_window, MAX_WINDOW);
+	}
+	if (m_received == m_segments.size()) {
+		finish();
+		return;
+	}
+	fill();
+}
+
+void BenchFetcher::onLoss(uint64_t seg) {
+	m_in_flight--;
+	Segment &segment = m_segments.at(seg);
+	if (m_finished || segment.done) {
+		fill();
+		return;
+	}
+	if (++segment.retries > MAX_RETRIES) {
+		m_finished = true;
+		m_error("Segment " + to_string(seg) + " failed after " +
+		        to_string(MAX_RETRIES) + " retransmissions");
+		return;
+	}
+	m_retransmissions++;
+	// Multiplicative decrease, once for all the losses of a window.
+	if (m_options.aimd && seg >= m_recovery_point) {
+		m_ssthresh = std::max(m_window / 2, MIN_WINDOW);
+		m_window = m_ssthresh;
+		m_recovery_point = m_next;
+	}
+	m_retx.push_back(seg);
+	fill();
+}
+
+void BenchFetcher::finish() {
+	m_finished = true;
+	m_done(toJson());
+}
+
+auto BenchFetcher::toJson() const -> std::string {
+	const double seconds =
+	    static_cast<double>(time::duration_cast<time::microseconds>(
+	                            time::steady_clock::now() - m_start)
+	                            .count()) /
+	    (US_PER_MS * US_PER_MS);
+	std::vector<double> latencies = m_latencies;
+	std::sort(latencies.begin(), latencies.end());
+	double sum = 0;
+	for (auto latency : latencies) {
+		sum += latency;
+	}
+	stringstream json;
+	json << R"({"prefix":")" << m_prefix << R"(","bytes":)" << m_options.bytes
+	     << R"(,"segments":)" << m_segments.size() << R"(,"seconds":)"
+	     << seconds << R"(,"goodput_mbps":)"
+	     << (seconds > 0 ? static_cast<double>(m_options.bytes) / seconds /
+	                           BYTES_PER_MBIT
+	                     : 0.0)
+	     << R"(,"window":")" << (m_options.aimd ? "aimd" : "fixed")
+	     << R"(","final_window":)" << m_window << R"(,"retransmissions":)"
+	     << m_retransmissions << R"(,"timeouts":)" << m_timeouts
+	     << R"(,"nacks":)" << m_nacks << R"(,"avg_ms":)"
+	     << (latencies.empty()
+	             ? 0.0
+	             : sum / static_cast<double>(latencies.size()))
+	     << R"(,"p50_ms":)" << percentile(latencies, 0.5) << R"(,"p90_ms":)"
+	     << percentile(latencies, 0.9) << R"(,"p99_ms":)"
+	     << percentile(latencies, 0.99) << R"(,"max_ms":)"
+	     << (latencies.empty() ? 0.0 : latencies.back()) << "}" << endl;
+	return json.str();
+}
+} // namespace ahnd
@@ -0,0 +1,62 @@
+#ifndef AHND_BENCH_H
+#define AHND_BENCH_H
+
+#include "statusinfo.h"
+
+#include <deque>
+
+namespace ahnd {
+
+// Content size of the synthetic segments served under /<prefix>/nd-bench and
+// the largest object that can be asked for.
+constexpr size_t BENCH_SEGMENT_SIZE = 4000;
+constexpr uint64_t MAX_BENCH_BYTES = 1024ULL * 1024 * 1024;
+
+// Fetches /<pier>/nd-bench/<size>/<seg> for every segment of a synthetic
+// object, keeping a fixed or AIMD controlled window of interests in flight,
+// and reports goodput, retransmissions and per-segment latency as JSON.
+class BenchFetcher : public std::enable_shared_from_this<BenchFetcher> {
+  private:
+	struct Segment {
+		ndn::time::steady_clock::time_point sent;
+		int retries{0};
+		bool done{false};
+	};
+
+	ndn::Face &m_face;
+	ndn::Name m_prefix;
+	BenchOptions m_options;
+	BenchDoneCallback m_done;
+	StatusErrorCallback m_error;
+	std::vector<Segment> m_segments;
+	// Next never sent segment and segments waiting to be sent again.
+	uint64_t m_next{0};
+	std::deque<uint64_t> m_retx;
+	uint64_t m_in_flight{0};
+	uint64_t m_received{0};
+	double m_window;
+	double m_ssthresh;
+	// Only back off once per window of losses.
+	uint64_t m_recovery_point{0};
+	long m_retransmissions{0};
+	long m_timeouts{0};
+	long m_nacks{0};
+	std::vector<double> m_latencies;
+	ndn::time::steady_clock::time_point m_start;
+	bool m_finished{false};
+
+	void fill();
+	void sendSegment(uint64_t seg);
+	void onData(uint64_t seg, const ndn::Data &data);
+	void onLoss(uint64_t seg);
+	void finish();
+	auto toJson() const -> std::string;
+
+  public:
+	BenchFetcher(ndn::Face &face, ndn::Name prefix, BenchOptions options,
+	             BenchDoneCallback done, StatusErrorCallback error);
+	void start();
+};
+} // namespace ahnd
+
+#endif // AHND_BENCH_H
@@ -0,0 +1,89 @@
+#include "bloomfilter.h"
+#include "ahnd-tlv.h"
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+// About a 1% false positive rate.
+constexpr size_t BITS_PER_ITEM = 10;
+constexpr uint32_t HASH_COUNT = 7;
+constexpr uint32_t MAX_HASH_COUNT = 32;
+constexpr size_t MIN_BYTES = 8;
+// Keep the digest small enough to fit in a multicast interest.  Past this the
+// false positive rate climbs but the per announcement seed keeps any single
+// member from being suppressed for long.
+constexpr size_t MAX_BYTES = 1024;
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+constexpr int HALF_SHIFT = 32;
+constexpr int BYTE_BITS = 8;
+
+BloomFilter::BloomFilter(size_t expected_items, uint32_t seed)
+    : m_seed(seed), m_hash_count(HASH_COUNT) {
+	size_t bytes = (expected_items * BITS_PER_ITEM + BYTE_BITS - 1) / BYTE_BITS;
+	m_bits.assign(std::min(std::max(bytes, MIN_BYTES), MAX_BYTES), 0);
+}
+
+BloomFilter::BloomFilter(const Block &block) {
+	block.parse();
+	m_seed = readNonNegativeIntegerAs<uint32_t>(block.get(DIGEST_SEED));
+	m_hash_count =
+	    readNonNegativeIntegerAs<uint32_t>(block.get(DIGEST_HASH_COUNT));
+	const Block &bits = block.get(DIGEST_BITS);
+	m_bits.assign(bits.value_begin(), bits.value_end());
+	if (m_bits.empty() || m_bits.size() > MAX_BYTES || m_hash_count == 0 ||
+	    m_hash_count > MAX_HASH_COUNT) {
+		throw tlv::Error("Invalid membership digest");
+	}
+}
+
+auto prefixHash(const Name &prefix, const uint64_t seed) -> uint64_t {
+	uint64_t h = FNV_OFFSET ^ seed;
+	const Block &wire = prefix.wireEncode();
+	for (auto it = wire.begin(); it != wire.end(); ++it) {
+		h ^= *it;
+		h *= FNV_PRIME;
+	}
+	return h;
+}
+
+auto BloomFilter::hash(const Name &prefix) const -> uint64_t {
+	return prefixHash(prefix, m_seed);
+}
+
+void BloomFilter::insert(const Name &prefix) {
+	const uint64_t h = hash(prefix);
+	const uint64_t h1 = h & 0xffffffffULL;
+	const uint64_t h2 = (h >> HALF_SHIFT) | 1;
+	const uint64_t nbits = m_bits.size() * BYTE_BITS;
+	for (uint32_t i = 0; i < m_hash_count; i++) {
+		const uint64_t bit = (h1 + i * h2) % nbits;
+		m_bits.at(bit / BYTE_BITS) |= (1U << (bit % BYTE_BITS));
+	}
+}
+
+auto BloomFilter::contains(const Name &prefix) const -> bool {
+	const uint64_t h = hash(prefix);
+	const uint64_t h1 = h & 0xffffffffULL;
+	const uint64_t h2 = (h >> HALF_SHIFT) | 1;
+	const uint64_t nbits = m_bits.size() * BYTE_BITS;
+	for (uint32_t i = 0; i < m_hash_count; i++) {
+		const uint64_t bit = (h1 + i * h2) % nbits;
+		if ((m_bits.at(bit / BYTE_BITS) & (1U << (bit % BYTE_BITS))) == 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+auto BloomFilter::wireEncode() const -> Block {
+	auto block = makeEmptyBlock(MEMBERSHIP_DIGEST);
+	block.push_back(makeNonNegativeIntegerBlock(DIGEST_SEED, m_seed));
+	block.push_back(makeNonNegativeIntegerBlock(DIGEST_HASH_COUNT, m_hash_count));
+	block.push_back(makeBinaryBlock(DIGEST_BITS, m_bits.data(), m_bits.size()));
+	block.encode();
+	return block;
+}
+} // namespace ahnd
@@ -0,0 +1,33 @@
+#ifndef AHND_BLOOMFILTER_H
+#define AHND_BLOOMFILTER_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+namespace ahnd {
+
+// Compact membership summary of the piers a node knows about.  This is sent
+// with arrival announcements so receivers that are already known to the
+// sender can skip replying.  The seed is chosen per announcement so a false
+// positive for a given prefix does not repeat on the next announcement.
+class BloomFilter {
+  private:
+	uint32_t m_seed;
+	uint32_t m_hash_count;
+	std::vector<uint8_t> m_bits;
+
+	auto hash(const ndn::Name &prefix) const -> uint64_t;
+
+  public:
+	BloomFilter(size_t expected_items, uint32_t seed);
+	explicit BloomFilter(const ndn::Block &block);
+	void insert(const ndn::Name &prefix);
+	auto contains(const ndn::Name &prefix) const -> bool;
+	auto wireEncode() const -> ndn::Block;
+};
+
+// FNV-1a over the prefix's wire encoding, the same on every node (unlike
+// std::hash) so nodes can compare results.
+auto prefixHash(const ndn::Name &prefix, uint64_t seed = 0) -> uint64_t;
+} // namespace ahnd
+
+#endif // AHND_BLOOMFILTER_H
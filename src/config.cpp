@@ -0,0 +1,163 @@
+#include "config.h"
+
+#include <fstream>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+constexpr long MAX_PORT = 65535;
+constexpr long DAY_SECONDS = 86400;
+constexpr long MAX_LIFETIME_MS = 600000;
+constexpr long MAX_LOOP_MS = 10000;
+constexpr long MAX_RETRY_BUDGET = 100000;
+constexpr long MAX_ANNOUNCE_LIMIT = 100000;
+
+struct TimingKey {
+	const char *name;
+	long Timing::*field;
+	long min;
+	long max;
+};
+
+static const std::array<TimingKey, 16> TIMING_KEYS{{
+    {"keepalive_s", &Timing::keepaliveSeconds, 1, DAY_SECONDS},
+    {"gossip_s", &Timing::gossipSeconds, 1, DAY_SECONDS},
+    {"loop_ms", &Timing::loopMs, 1, MAX_LOOP_MS},
+    {"interest_lifetime_ms", &Timing::interestLifetimeMs, 100,
+     MAX_LIFETIME_MS},
+    {"discovery_lifetime_ms", &Timing::discoveryLifetimeMs, 100,
+     MAX_LIFETIME_MS},
+    {"freshness_ms", &Timing::freshnessMs, 0, MAX_LIFETIME_MS},
+    {"arrival_reply_slot_ms", &Timing::arrivalReplySlotMs, 0,
+     MAX_LIFETIME_MS},
+    {"arrival_reply_max_ms", &Timing::arrivalReplyMaxMs, 0, MAX_LIFETIME_MS},
+    {"suspect_probe_s", &Timing::suspectProbeSeconds, 0, DAY_SECONDS},
+    {"retry_budget", &Timing::retryBudget, 1, MAX_RETRY_BUDGET},
+    {"passive_liveness", &Timing::passiveLiveness, 0, 1},
+    {"announce_rate", &Timing::announceRate, 0, MAX_ANNOUNCE_LIMIT},
+    {"announce_burst", &Timing::announceBurst, 1, MAX_ANNOUNCE_LIMIT},
+    {"max_pending_piers", &Timing::maxPendingPiers, 1, MAX_ANNOUNCE_LIMIT},
+    {"max_piers", &Timing::maxPiers, 1, MAX_ANNOUNCE_LIMIT},
+    {"max_piers_per_source", &Timing::maxPiersPerSource, 1,
+     MAX_ANNOUNCE_LIMIT},
+}};
+
+static auto trim(const string &text) -> string {
+	const size_t begin = text.find_first_not_of(" \t\r\n");
+	if (begin == string::npos) {
+		return "";
+	}
+	return text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+}
+
+static auto parseNumber(const string &key, const string &value, long min,
+                        long max) -> long {
+	size_t used = 0;
+	long number = 0;
+	try {
+		number = stol(value, &used);
+	} catch (const logic_error &e) {
+		used = 0;
+	}
+	if (used == 0 || used != value.size() || number < min || number > max) {
+		throw invalid_argument(key + " takes a number from " + to_string(min) +
+		                       " to " + to_string(max));
+	}
+	return number;
+}
+
+void Config::set(const string &key, const string &value, const bool running) {
+	for (const auto &timing_key : TIMING_KEYS) {
+		if (key == timing_key.name) {
+			m_timing.*timing_key.field =
+			    parseNumber(key, value, timing_key.min, timing_key.max);
+			return;
+		}
+	}
+	if (key == "port" || key == "broadcast_prefix") {
+		if (running) {
+			throw invalid_argument(key + " can only be set at startup");
+		}
+		if (key == "port") {
+			m_port =
+			    static_cast<uint16_t>(parseNumber(key, value, 1, MAX_PORT));
+		} else {
+			m_broadcast_prefix = Name(value);
+		}
+		return;
+	}
+	throw invalid_argument("unknown setting " + key);
+}
+
+auto Config::load(const string &path, const bool running) -> vector<string> {
+	m_path = path;
+	vector<string> errors;
+	ifstream file(path);
+	if (!file) {
+		errors.push_back("can not read " + path);
+		return errors;
+	}
+	string line;
+	int line_no = 0;
+	while (getline(file, line)) {
+		line_no++;
+		line = trim(line.substr(0, line.find('#')));
+		if (line.empty()) {
+			continue;
+		}
+		const size_t equals = line.find('=');
+		const string where = path + ":" + to_string(line_no) + ": ";
+		if (equals == string::npos) {
+			errors.push_back(where + "expected key = value");
+			continue;
+		}
+		const string key = trim(line.substr(0, equals));
+		if (running && (key == "port" || key == "broadcast_prefix")) {
+			// Fine in the file, it only takes effect on the next start.
+			continue;
+		}
+		try {
+			set(key, trim(line.substr(equals + 1)), running);
+		} catch (const invalid_argument &e) {
+			errors.push_back(where + e.what());
+		}
+	}
+	return errors;
+}
+
+auto Config::reload() -> vector<string> {
+	if (m_path.empty()) {
+		return {"no config file given (-c)"};
+	}
+	return load(m_path, true);
+}
+
+auto Config::get(const string &key) const -> string {
+	for (const auto &timing_key : TIMING_KEYS) {
+		if (key == timing_key.name) {
+			return to_string(m_timing.*timing_key.field);
+		}
+	}
+	if (key == "port") {
+		return to_string(m_port);
+	}
+	if (key == "broadcast_prefix") {
+		return m_broadcast_prefix.toUri();
+	}
+	throw invalid_argument("unknown setting " + key);
+}
+
+auto Config::json() const -> string {
+	stringstream out;
+	out << "{";
+	for (const auto &timing_key : TIMING_KEYS) {
+		out << '"' << timing_key.name << R"(":)" << m_timing.*timing_key.field
+		    << ",";
+	}
+	out << R"("port":)" << m_port << R"(,"broadcast_prefix":")"
+	    << m_broadcast_prefix << R"("})";
+	return out.str();
+}
+} // namespace ahnd
@@ -0,0 +1,71 @@
+#ifndef AHND_CONFIG_H
+#define AHND_CONFIG_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+namespace ahnd {
+
+// Timing and scaling knobs that can change while the client runs.
+struct Timing {
+	long keepaliveSeconds{300};
+	long gossipSeconds{60};
+	// Longest the agent loop waits in processEvents.
+	long loopMs{500};
+	// Lifetime of interests to piers (keepalive, nd-info, status).
+	long interestLifetimeMs{30000};
+	// Lifetime of the multicast arrival, departure and gossip interests.
+	long discoveryLifetimeMs{4000};
+	long freshnessMs{4000};
+	// Arrival reply backoff, the window is the slot per known member capped
+	// at the max.
+	long arrivalReplySlotMs{10};
+	long arrivalReplyMaxMs{2000};
+	long suspectProbeSeconds{1};
+	// Retries that may wait their backoff at once, more are queued until
+	// one of those ran, see RetryPolicy.
+	long retryBudget{32};
+	// Skip the keepalive probe of a pier heard from since the last round
+	// (its face counters moved or it sent us nd-info or a keepalive), 0 or 1.
+	long passiveLiveness{0};
+	// Announcements per second (and burst) accepted from one address, 0
+	// turns the limit off, piers set up at once before new ones are
+	// deferred, and piers kept in all and per announcing address, see
+	// Admission.
+	long announceRate{10};
+	long announceBurst{20};
+	long maxPendingPiers{64};
+	long maxPiers{4096};
+	long maxPiersPerSource{16};
+};
+
+// Client settings from an optional `key = value` file (# starts a comment)
+// and the agent's set command.  Everything in Timing can be changed at any
+// time, the port and broadcast prefix only before the client starts.
+class Config {
+  private:
+	Timing m_timing;
+	uint16_t m_port{6363};
+	ndn::Name m_broadcast_prefix{"/ahnd"};
+	std::string m_path;
+
+  public:
+	// Throws std::invalid_argument for an unknown key or a bad value, and
+	// for a startup only key once running.
+	void set(const std::string &key, const std::string &value, bool running);
+	// Apply a config file, returns the problems found (lines with them are
+	// skipped).  Remembered for reload().
+	auto load(const std::string &path, bool running)
+	    -> std::vector<std::string>;
+	auto reload() -> std::vector<std::string>;
+	auto get(const std::string &key) const -> std::string;
+	// All settings as a JSON object.
+	auto json() const -> std::string;
+	auto timing() const -> const Timing & { return m_timing; }
+	auto port() const -> uint16_t { return m_port; }
+	auto broadcastPrefix() const -> const ndn::Name & {
+		return m_broadcast_prefix;
+	}
+};
+} // namespace ahnd
+
+#endif // AHND_CONFIG_H
@@ -0,0 +1,83 @@
+#include "datatemplate.h"
+
+#include <ndn-cxx/util/sha256.hpp>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+constexpr uint8_t DIGEST_SIZE = 32;
+constexpr uint64_t ONE_OCTET_MAX = 252;
+constexpr uint8_t TWO_OCTETS = 253;
+constexpr uint8_t FOUR_OCTETS = 254;
+constexpr uint8_t EIGHT_OCTETS = 255;
+constexpr uint64_t TWO_OCTETS_MAX = 0xffff;
+constexpr uint64_t FOUR_OCTETS_MAX = 0xffffffff;
+constexpr int BYTE_BITS = 8;
+
+// TLV VAR-NUMBER encoding, returns the position after it.
+static auto writeVarNumber(uint8_t *out, uint64_t number) -> uint8_t * {
+	int bytes = 0;
+	if (number <= ONE_OCTET_MAX) {
+		*out++ = static_cast<uint8_t>(number);
+		return out;
+	}
+	if (number <= TWO_OCTETS_MAX) {
+		*out++ = TWO_OCTETS;
+		bytes = 2;
+	} else if (number <= FOUR_OCTETS_MAX) {
+		*out++ = FOUR_OCTETS;
+		bytes = 4;
+	} else {
+		*out++ = EIGHT_OCTETS;
+		bytes = BYTE_BITS;
+	}
+	for (int i = bytes - 1; i >= 0; i--) {
+		*out++ = static_cast<uint8_t>(number >> (i * BYTE_BITS));
+	}
+	return out;
+}
+
+DataTemplate::DataTemplate(time::milliseconds freshness,
+                           const Buffer &content) {
+	// Encoded the way ndn-cxx encodes a Data signed with DigestSha256.  Done
+	// by hand rather than through the KeyChain (which is not thread safe) so
+	// templates can be built on a worker.
+	Block meta_info(tlv::MetaInfo);
+	if (freshness.count() > 0) {
+		meta_info.push_back(makeNonNegativeIntegerBlock(
+		    tlv::FreshnessPeriod, static_cast<uint64_t>(freshness.count())));
+	}
+	meta_info.encode();
+	Block payload =
+	    makeBinaryBlock(tlv::Content, content.data(), content.size());
+	Block signature_info(tlv::SignatureInfo);
+	signature_info.push_back(
+	    makeNonNegativeIntegerBlock(tlv::SignatureType, tlv::DigestSha256));
+	signature_info.encode();
+	for (const Block *block : {&meta_info, &payload, &signature_info}) {
+		m_tail.insert(m_tail.end(), block->begin(), block->end());
+	}
+}
+
+auto DataTemplate::make(const Name &name) const -> Data {
+	// The name of a received interest already has its wire encoding.
+	const Block &name_wire = name.wireEncode();
+	const size_t signed_size = name_wire.size() + m_tail.size();
+	const size_t value_size = signed_size + 2 + DIGEST_SIZE;
+	auto buffer = make_shared<Buffer>(tlv::sizeOfVarNumber(tlv::Data) +
+	                                  tlv::sizeOfVarNumber(value_size) +
+	                                  value_size);
+	uint8_t *out = writeVarNumber(buffer->data(), tlv::Data);
+	out = writeVarNumber(out, value_size);
+	const uint8_t *signed_begin = out;
+	out = std::copy(name_wire.begin(), name_wire.end(), out);
+	out = std::copy(m_tail.begin(), m_tail.end(), out);
+	*out++ = tlv::SignatureValue;
+	*out++ = DIGEST_SIZE;
+	auto digest = util::Sha256::computeDigest(signed_begin, signed_size);
+	std::copy(digest->begin(), digest->end(), out);
+	return Data(Block(std::move(buffer)));
+}
+} // namespace ahnd
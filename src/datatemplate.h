@@ -0,0 +1,24 @@
+#ifndef AHND_DATATEMPLATE_H
+#define AHND_DATATEMPLATE_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+namespace ahnd {
+
+// Pre-encoded DigestSha256 signed Data for responders that answer with the
+// same content and freshness every time (keepalive, ping and arrival acks).
+// The MetaInfo, Content and SignatureInfo are encoded once, making a response
+// only copies the name in and hashes the signed portion.  Needs no KeyChain,
+// a one off template can be built and used on a worker thread.
+class DataTemplate {
+  private:
+	// Everything between the Name and the SignatureValue.
+	ndn::Buffer m_tail;
+
+  public:
+	DataTemplate(ndn::time::milliseconds freshness, const ndn::Buffer &content);
+	auto make(const ndn::Name &name) const -> ndn::Data;
+};
+} // namespace ahnd
+
+#endif // AHND_DATATEMPLATE_H
@@ -0,0 +1,98 @@
+#include "election.h"
+#include "bloomfilter.h"
+
+#include <sstream>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+// Members remembered per delegate, spares so a delegate that leaves is
+// replaced right away instead of after the next round of announcements.
+constexpr size_t CANDIDATES_PER_DELEGATE = 4;
+
+Election::Election(Name self, size_t count)
+    : m_self(std::move(self)), m_self_rank(prefixHash(m_self), m_self),
+      m_count(std::max<size_t>(count, 1)) {}
+
+auto Election::elected() const -> std::vector<Name> {
+	std::vector<Name> names;
+	bool self_placed = false;
+	for (const auto &candidate : m_candidates) {
+		if (!self_placed && m_self_rank < candidate.first &&
+		    names.size() < m_count) {
+			names.push_back(m_self);
+			self_placed = true;
+		}
+		if (names.size() >= m_count) {
+			break;
+		}
+		names.push_back(candidate.second.prefix);
+	}
+	if (!self_placed && names.size() < m_count) {
+		names.push_back(m_self);
+	}
+	return names;
+}
+
+auto Election::heard(const Member &member) -> bool {
+	if (member.prefix.equals(m_self)) {
+		return false;
+	}
+	const auto before = elected();
+	const Rank rank(prefixHash(member.prefix), member.prefix);
+	m_candidates[rank] = member;
+	while (m_candidates.size() > m_count * CANDIDATES_PER_DELEGATE) {
+		m_candidates.erase(std::prev(m_candidates.end()));
+	}
+	return elected() != before;
+}
+
+auto Election::forget(const Name &prefix) -> bool {
+	const auto before = elected();
+	m_candidates.erase(Rank(prefixHash(prefix), prefix));
+	return elected() != before;
+}
+
+auto Election::expire(const time::steady_clock::time_point before) -> bool {
+	const auto was = elected();
+	for (auto it = m_candidates.begin(); it != m_candidates.end();) {
+		if (it->second.heard < before) {
+			it = m_candidates.erase(it);
+		} else {
+			++it;
+		}
+	}
+	return elected() != was;
+}
+
+auto Election::isDelegate(const Name &prefix) const -> bool {
+	const auto names = elected();
+	return std::find(names.begin(), names.end(), prefix) != names.end();
+}
+
+auto Election::delegates() const -> std::vector<Member> {
+	std::vector<Member> members;
+	for (const auto &name : elected()) {
+		if (name.equals(m_self)) {
+			continue;
+		}
+		members.push_back(m_candidates.at(Rank(prefixHash(name), name)));
+	}
+	return members;
+}
+
+auto Election::json() const -> string {
+	stringstream out;
+	out << R"({"delegates":)" << m_count << R"(,"self_delegate":)"
+	    << (selfDelegate() ? "true" : "false") << R"(,"candidates":)"
+	    << m_candidates.size() << R"(,"elected":[)";
+	const auto names = elected();
+	for (size_t i = 0; i < names.size(); i++) {
+		out << (i > 0 ? "," : "") << '"' << names.at(i) << '"';
+	}
+	out << "]}";
+	return out.str();
+}
+} // namespace ahnd
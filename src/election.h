@@ -0,0 +1,54 @@
+#ifndef AHND_ELECTION_H
+#define AHND_ELECTION_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+#include <netinet/in.h>
+
+namespace ahnd {
+
+// A member heard announcing itself, enough to set up a face to it.
+struct Member {
+	ndn::Name prefix;
+	in_addr ip{0};
+	in6_addr ip6{};
+	bool hasIp6{false};
+	uint16_t port{0};
+	ndn::time::steady_clock::time_point heard;
+	// Routed over its face along with the prefix once it is a delegate.
+	std::vector<ndn::Name> extraPrefixes;
+};
+
+// Picks the delegates of a segment: the members (us included) with the
+// lowest prefix hash, ties going to the lower prefix.  Every member ranks
+// the same way so they agree on the delegates once they have heard the same
+// announcements.  Only the lowest ranked members are remembered, which is
+// all an election needs, so the state does not grow with the segment.
+class Election {
+  private:
+	using Rank = std::pair<uint64_t, ndn::Name>;
+
+	ndn::Name m_self;
+	Rank m_self_rank;
+	size_t m_count;
+	std::map<Rank, Member> m_candidates;
+
+	auto elected() const -> std::vector<ndn::Name>;
+
+  public:
+	Election(ndn::Name self, size_t count);
+	// These return whether the delegates changed.
+	auto heard(const Member &member) -> bool;
+	auto forget(const ndn::Name &prefix) -> bool;
+	// Drop members not heard since before.
+	auto expire(ndn::time::steady_clock::time_point before) -> bool;
+	auto isDelegate(const ndn::Name &prefix) const -> bool;
+	auto selfDelegate() const -> bool { return isDelegate(m_self); }
+	// The delegates other than us.
+	auto delegates() const -> std::vector<Member>;
+	auto count() const -> size_t { return m_count; }
+	auto json() const -> std::string;
+};
+} // namespace ahnd
+
+#endif // AHND_ELECTION_H
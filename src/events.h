@@ -0,0 +1,132 @@
+#ifndef AHND_EVENTS_H
+#define AHND_EVENTS_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+#include <netinet/in.h>
+
+#include "faceprofile.h"
+
+namespace ahnd {
+
+// Lifecycle of a pier.  A pier moves forward one NFD command at a time so
+// there is never more than one face or route operation in flight for it,
+// triggers that arrive meanwhile (repeated arrivals, moves, races) are folded
+// into the operation already running or wait for CONFIRMED.
+enum class PierState {
+	DISCOVERED,    // Announced itself, nothing asked of NFD yet.
+	FACE_PENDING,  // faces/create in flight (or waiting to retry).
+	ROUTE_PENDING, // Face is up, rib/register of its prefix in flight.
+	CONFIRMED,     // Face and route up, keepalives answered.
+	SUSPECT,       // Missed a keepalive, probed once more before removal.
+	TEARING_DOWN   // Being removed, nothing new is started for it.
+};
+
+auto pierStateName(PierState state) -> const char *;
+
+struct DBEntry {
+	const long id;
+	struct in_addr ip {
+		0
+	};
+	// IPv6 address the pier announced, if any, and whether its face uses
+	// it rather than ip.
+	in6_addr ip6{};
+	bool hasIp6{false};
+	bool useIp6{false};
+	uint16_t port;
+	// Set when the pier is reached over a unicast Ethernet face.
+	std::string mac;
+	ndn::Name prefix;
+	// Other prefixes served by the pier, routed over the same face.
+	std::vector<ndn::Name> extraPrefixes;
+	int faceId;
+	// Round trip measurements, taken from keepalive, nd-info and gossip
+	// exchanges, and the route cost derived from them.
+	double srttMs{0};
+	double lossRate{0};
+	long rttSamples{0};
+	int cost{0};
+	// Link the face runs over and whether measured loss turned LP
+	// reliability on for it.
+	LinkClass link{LinkClass::LAN};
+	bool lossy{false};
+	// Face on the other address family while the two are raced, the probes
+	// still outstanding and the best RTT seen on each family.
+	int raceFaceId{0};
+	int raceProbes{0};
+	double race4Ms{0};
+	double race6Ms{0};
+	PierState state{PierState::DISCOVERED};
+	// Our nd-info is in flight to the pier (or waiting to retry), or was
+	// asked for before its route was up and goes out once it is.
+	bool infoPending{false};
+	bool infoWanted{false};
+	// First announcement of a pier not yet confirmed, for LoadStats.
+	ndn::time::steady_clock::time_point discovered;
+	// Passive liveness: when the pier last sent us nd-info or a keepalive
+	// (multicast arrivals do not count, every member sends them), and its
+	// face's incoming counters as of the last keepalive round.
+	ndn::time::steady_clock::time_point heard;
+	int countersFaceId{0};
+	uint64_t faceInInterests{0};
+	uint64_t faceInData{0};
+	// Tracer track of the pier, unlike the slot's id never reused.
+	long track{0};
+
+	DBEntry() : id(count++) {
+		port = 0;
+		faceId = 0;
+	}
+	// Reset a free slot for a new pier, the id stays.
+	void clear();
+
+  private:
+	// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+	static long count;
+};
+
+using VisitPiersCallback = std::function<void(const DBEntry &pier)>;
+using PierCallback = std::function<void(const DBEntry &pier)>;
+using RouteCallback =
+    std::function<void(const ndn::Name &prefix, int face_id, int cost)>;
+
+// Topology changes delivered to an application embedding the client, called
+// on the face's io_service thread.  Any of them may be left empty.
+struct PierEvents {
+	// The pier's face and route are up.  Ups and downs of a pier alternate.
+	PierCallback pierUp;
+	// A pier that was up is being removed (departed, stopped answering or
+	// its link went away) or moves to a new face, up again once that is.
+	PierCallback pierDown;
+	// A route to a pier's prefix, one of its extra prefixes or a gossiped
+	// prefix was registered (again, when its cost or face changes).
+	RouteCallback routeReady;
+};
+
+// Replies to status, bench and ping requests, called on the face's io_service
+// thread once the answer is complete.
+using StatusCallback = std::function<void(std::string json)>;
+using StatusErrorCallback = std::function<void(std::string reason)>;
+
+struct BenchOptions {
+	uint64_t bytes{10 * 1024 * 1024};
+	// Interests in flight, the starting window with AIMD.
+	double window{16};
+	bool aimd{true};
+};
+
+using BenchDoneCallback = std::function<void(const std::string &json)>;
+
+struct PingOptions {
+	long count{10};
+	long intervalMs{100};
+	// Payload the responder should send back, 0 for its default.
+	size_t payloadSize{0};
+};
+
+using PingDoneCallback = std::function<void(const std::string &json)>;
+
+} // namespace ahnd
+
+#endif
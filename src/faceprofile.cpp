@@ -0,0 +1,75 @@
+#include "faceprofile.h"
+#include "nfd-command-tlv.h"
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+// Face flag bits, see the NFD management protocol.
+constexpr uint64_t LP_RELIABILITY_BIT = 1U << 1U;
+constexpr uint64_t CONGESTION_MARKING_BIT = 1U << 2U;
+constexpr uint64_t NS_PER_MS = 1000000;
+// Queue allowed to build on fast local links before marking, NFD's default
+// (64KB at most) throttles bulk transfers there.
+constexpr uint64_t FAST_LINK_THRESHOLD = 256 * 1024;
+
+void FaceProfile::addTo(Block &control) const {
+	uint64_t flags = 0;
+	if (lpReliability) {
+		flags |= LP_RELIABILITY_BIT;
+	}
+	if (congestionMarking) {
+		flags |= CONGESTION_MARKING_BIT;
+	}
+	// In the order of the ControlParameters definition.
+	control.push_back(makeNonNegativeIntegerBlock(FLAGS, flags));
+	control.push_back(makeNonNegativeIntegerBlock(
+	    MASK, LP_RELIABILITY_BIT | CONGESTION_MARKING_BIT));
+	control.push_back(
+	    makeNonNegativeIntegerBlock(FACE_PERSISTENCY, persistency));
+	if (congestionIntervalMs > 0) {
+		control.push_back(
+		    makeNonNegativeIntegerBlock(BASE_CONGESTION_MARKING_INTERVAL,
+		                                congestionIntervalMs * NS_PER_MS));
+	}
+	if (congestionThreshold > 0) {
+		control.push_back(makeNonNegativeIntegerBlock(
+		    DEFAULT_CONGESTION_THRESHOLD, congestionThreshold));
+	}
+	if (mtu > 0) {
+		control.push_back(makeNonNegativeIntegerBlock(MTU, mtu));
+	}
+}
+
+auto defaultFaceProfile(LinkClass link) -> FaceProfile {
+	// Discovered faces are persistent so NFD does not idle them out, piers
+	// are removed by keepalive failures and departures instead.
+	FaceProfile profile{PERSISTENCY_PERSISTENT};
+	switch (link) {
+	case LinkClass::ETHER:
+	case LinkClass::LAN:
+		profile.congestionThreshold = FAST_LINK_THRESHOLD;
+		break;
+	case LinkClass::WIRELESS:
+	case LinkClass::WAN:
+		profile.lpReliability = true;
+		break;
+	}
+	return profile;
+}
+
+auto linkClassName(LinkClass link) -> const char * {
+	switch (link) {
+	case LinkClass::ETHER:
+		return "ether";
+	case LinkClass::LAN:
+		return "lan";
+	case LinkClass::WIRELESS:
+		return "wireless";
+	case LinkClass::WAN:
+		return "wan";
+	}
+	return "unknown";
+}
+} // namespace ahnd
@@ -0,0 +1,32 @@
+#ifndef AHND_FACEPROFILE_H
+#define AHND_FACEPROFILE_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+namespace ahnd {
+
+// What kind of link a pier's face runs over, selects its FaceProfile.
+enum class LinkClass { ETHER, LAN, WIRELESS, WAN };
+
+// NFD face settings applied when a pier's face is created (faces/create) and
+// when they change (faces/update).  A zero value leaves the NFD default.
+struct FaceProfile {
+	int persistency;
+	// Only UDP faces take an MTU override.
+	uint64_t mtu{0};
+	uint64_t congestionIntervalMs{0};
+	// Bytes queued before congestion marking kicks in.
+	uint64_t congestionThreshold{0};
+	bool congestionMarking{true};
+	bool lpReliability{false};
+
+	// Append these settings to faces/create or faces/update control
+	// parameters.
+	void addTo(ndn::Block &control) const;
+};
+
+auto defaultFaceProfile(LinkClass link) -> FaceProfile;
+auto linkClassName(LinkClass link) -> const char *;
+} // namespace ahnd
+
+#endif // AHND_FACEPROFILE_H
@@ -0,0 +1,71 @@
+#include "handoffqueue.h"
+
+using namespace std;
+
+namespace ahnd {
+
+static auto roundUpPow2(size_t value) -> size_t {
+	size_t pow2 = 2;
+	while (pow2 < value) {
+		pow2 <<= 1U;
+	}
+	return pow2;
+}
+
+HandoffQueue::HandoffQueue(size_t capacity)
+    : m_cells(new Cell[roundUpPow2(capacity)]),
+      m_mask(roundUpPow2(capacity) - 1) {
+	for (size_t i = 0; i <= m_mask; i++) {
+		m_cells[i].sequence.store(i, memory_order_relaxed);
+	}
+}
+
+auto HandoffQueue::push(Task &task) -> bool {
+	size_t pos = m_enqueue.load(memory_order_relaxed);
+	for (;;) {
+		Cell &cell = m_cells[pos & m_mask];
+		const size_t seq = cell.sequence.load(memory_order_acquire);
+		const auto diff =
+		    static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+		if (diff == 0) {
+			// The cell is free for this lap, claim it.
+			if (m_enqueue.compare_exchange_weak(pos, pos + 1,
+			                                    memory_order_relaxed)) {
+				cell.task = std::move(task);
+				cell.sequence.store(pos + 1, memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			// Still holds a task from the previous lap, full.
+			return false;
+		} else {
+			pos = m_enqueue.load(memory_order_relaxed);
+		}
+	}
+}
+
+auto HandoffQueue::pop(Task &task) -> bool {
+	size_t pos = m_dequeue.load(memory_order_relaxed);
+	for (;;) {
+		Cell &cell = m_cells[pos & m_mask];
+		const size_t seq = cell.sequence.load(memory_order_acquire);
+		const auto diff =
+		    static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+		if (diff == 0) {
+			if (m_dequeue.compare_exchange_weak(pos, pos + 1,
+			                                    memory_order_relaxed)) {
+				task = std::move(cell.task);
+				cell.task = nullptr;
+				// Free the cell for the producers' next lap.
+				cell.sequence.store(pos + m_mask + 1, memory_order_release);
+				return true;
+			}
+		} else if (diff < 0) {
+			// Nothing published here yet, empty.
+			return false;
+		} else {
+			pos = m_dequeue.load(memory_order_relaxed);
+		}
+	}
+}
+} // namespace ahnd
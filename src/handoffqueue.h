@@ -0,0 +1,43 @@
+#ifndef AHND_HANDOFFQUEUE_H
+#define AHND_HANDOFFQUEUE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace ahnd {
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Bounded lock-free multi-producer multi-consumer queue of tasks (a ring of
+// cells each carrying a sequence number, after Dmitry Vyukov's design).
+// Neither side ever blocks, push fails when the ring is full and pop when it
+// is empty.
+class HandoffQueue {
+  public:
+	using Task = std::function<void()>;
+
+  private:
+	struct Cell {
+		std::atomic<size_t> sequence;
+		Task task;
+	};
+	std::unique_ptr<Cell[]> m_cells;
+	const size_t m_mask;
+	// Keep the producer and consumer positions off each other's cache line.
+	std::atomic<size_t> m_enqueue{0};
+	char m_pad[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)]{};
+	std::atomic<size_t> m_dequeue{0};
+
+  public:
+	// Capacity is rounded up to a power of two.
+	explicit HandoffQueue(size_t capacity);
+	HandoffQueue(const HandoffQueue &) = delete;
+	auto operator=(const HandoffQueue &) -> HandoffQueue & = delete;
+	// Moves task in and returns true, or leaves it alone if the queue is full.
+	auto push(Task &task) -> bool;
+	auto pop(Task &task) -> bool;
+};
+} // namespace ahnd
+
+#endif // AHND_HANDOFFQUEUE_H
@@ -0,0 +1,485 @@
+#include "pinger.h"
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <ndn-cxx/util/random.hpp>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace ndn;
+using namespace ahnd;
+using namespace std;
+
+constexpr double DEFAULT_RATE = 100;
+constexpr long DEFAULT_COUNT = 1000;
+constexpr long DEFAULT_ADDRESSES = 254;
+constexpr uint16_t PIER_PORT = 6363;
+constexpr auto ANNOUNCEMENT_LIFETIME = 4_s;
+constexpr auto TICK = 1_ms;
+constexpr auto REPORT_INTERVAL = 1_s;
+// How long to wait for the last replies and the agent's final stats.
+constexpr auto DRAIN_TIME = 5_s;
+constexpr auto AGENT_WAIT = 1_s;
+constexpr auto SHUTDOWN_DELAY = 200_ms;
+constexpr size_t AGENT_BUF_LEN = 4096;
+constexpr double NS_PER_MS = 1000000.0;
+constexpr double MS_PER_S = 1000.0;
+
+enum class Mode { ARRIVAL, ND_INFO };
+
+// Which synthetic pier each interest announces.  Sequential walks the pool,
+// uniform and zipf (s = 1, a few piers announce far more often than the rest)
+// pick at random.
+enum class Distribution { SEQUENTIAL, UNIFORM, ZIPF };
+
+struct LoadOptions {
+	Mode mode{Mode::ARRIVAL};
+	double rate{DEFAULT_RATE};
+	long count{DEFAULT_COUNT};
+	// Distinct pier prefixes, 0 for one per interest.
+	long prefixes{0};
+	Distribution distribution{Distribution::SEQUENTIAL};
+	Name base{"/loadgen"};
+	Name broadcast{"/ahnd"};
+	// The daemon's prefix, nd-info interests go to <target>/nd-info.
+	Name target;
+	// Synthetic pier addresses start here (host order), a pier keeps its
+	// address for the whole run.
+	uint32_t firstIp{0x0aff0001};
+	long addresses{DEFAULT_ADDRESSES};
+	string socketPath{"/tmp/ah"};
+	bool depart{true};
+};
+
+// Value of a top level number in the agent's JSON, "?" if it is missing.
+static auto jsonField(const string &json, const string &key) -> string {
+	const string needle = "\"" + key + "\":";
+	const size_t at = json.find(needle);
+	if (at == string::npos) {
+		return "?";
+	}
+	const size_t begin = at + needle.size();
+	return json.substr(begin, json.find_first_of(",}", begin) - begin);
+}
+
+// A flat object in the agent's JSON, "null" if it is missing.
+static auto jsonObject(const string &json, const string &key) -> string {
+	const string needle = "\"" + key + "\":{";
+	const size_t at = json.find(needle);
+	if (at == string::npos) {
+		return "null";
+	}
+	const size_t begin = at + needle.size() - 1;
+	return json.substr(begin, json.find('}', begin) + 1 - begin);
+}
+
+// Sends synthetic announcements to a running daemon at a fixed rate and
+// reports how fast they are answered along with the daemon's own view (the
+// agent's stats command): handling latency, provisioning latency and the
+// NFD command backlog.  Reply latency is only measured for nd-info, an
+// arrival is answered after a random backoff and by a few members only, so
+// arrival runs measure throughput and take latency from the agent.
+class LoadGenerator {
+  public:
+	explicit LoadGenerator(LoadOptions options)
+	    : m_scheduler(m_face.getIoService()), m_options(std::move(options)) {
+		const long pool = poolSize();
+		if (m_options.distribution == Distribution::ZIPF) {
+			double sum = 0;
+			for (long i = 1; i <= pool; i++) {
+				sum += 1.0 / static_cast<double>(i);
+				m_zipf_cdf.push_back(sum);
+			}
+			for (auto &p : m_zipf_cdf) {
+				p /= sum;
+			}
+		}
+	}
+
+	void run() {
+		connectAgent();
+		requestStats("stats reset");
+		m_start = time::steady_clock::now();
+		m_next_report = m_start + REPORT_INTERVAL;
+		cout << "AH Loadgen: Sending " << m_options.count << " "
+		     << (m_options.mode == Mode::ARRIVAL ? "arrival" : "nd-info")
+		     << " interests at " << m_options.rate << "/s over "
+		     << poolSize() << " piers" << endl;
+		m_scheduler.schedule(TICK, [this] { tick(); });
+		m_face.processEvents();
+		if (m_agent != -1) {
+			close(m_agent);
+		}
+	}
+
+  private:
+	Face m_face;
+	Scheduler m_scheduler;
+	LoadOptions m_options;
+	std::vector<double> m_zipf_cdf;
+	time::steady_clock::time_point m_start;
+	time::steady_clock::time_point m_next_report;
+	long m_sent{0};
+	long m_outstanding{0};
+	long m_acked{0};
+	long m_nacks{0};
+	long m_timeouts{0};
+	std::vector<double> m_latencies;
+	// Every prefix announced, for the departures at the end.
+	std::vector<bool> m_announced;
+	// When the last interest went out.
+	time::steady_clock::time_point m_all_sent;
+	int m_agent{-1};
+	string m_agent_reply;
+	bool m_agent_waiting{false};
+	string m_agent_stats;
+
+	auto poolSize() const -> long {
+		return m_options.prefixes > 0 ? m_options.prefixes
+		                              : m_options.count;
+	}
+
+	auto pickPier(long seq) -> long {
+		auto &rng = random::getRandomNumberEngine();
+		switch (m_options.distribution) {
+		case Distribution::SEQUENTIAL:
+			break;
+		case Distribution::UNIFORM:
+			return std::uniform_int_distribution<long>(0, poolSize() - 1)(rng);
+		case Distribution::ZIPF: {
+			const double p = std::uniform_real_distribution<double>(0, 1)(rng);
+			return std::min<long>(
+			    std::lower_bound(m_zipf_cdf.begin(), m_zipf_cdf.end(), p) -
+			        m_zipf_cdf.begin(),
+			    poolSize() - 1);
+		}
+		}
+		return seq % poolSize();
+	}
+
+	// <prefix>/<kind>/<ip>/<port>/<prefix_length>/<pier prefix>/<timestamp>,
+	// the format AHClient announces itself with.
+	auto announcementName(const Name &prefix, const char *kind, long pier)
+	    -> Name {
+		Name pier_prefix(m_options.base);
+		pier_prefix.append("p" + to_string(pier));
+		const in_addr ip{htonl(
+		    m_options.firstIp +
+		    static_cast<uint32_t>(pier % std::max(m_options.addresses, 1L)))};
+		const uint16_t port = htons(PIER_PORT);
+		Name name(prefix);
+		name.append(kind);
+		// NOLINTNEXTLINE: unsafe C style cast
+		name.append((const uint8_t *)&ip, sizeof(ip));
+		// NOLINTNEXTLINE: unsafe C style cast
+		name.append((const uint8_t *)&port, sizeof(port));
+		name.appendNumber(pier_prefix.size())
+		    .append(pier_prefix)
+		    .appendTimestamp();
+		return name;
+	}
+
+	void sendOne(long seq) {
+		const long pier = pickPier(seq);
+		if (m_announced.size() < static_cast<size_t>(poolSize())) {
+			m_announced.resize(poolSize());
+		}
+		m_announced.at(pier) = true;
+		Interest interest(m_options.mode == Mode::ARRIVAL
+		                      ? announcementName(m_options.broadcast,
+		                                         "arrival", pier)
+		                      : announcementName(m_options.target, "nd-info",
+		                                         pier));
+		interest.setInterestLifetime(ANNOUNCEMENT_LIFETIME);
+		interest.setMustBeFresh(true);
+		interest.setCanBePrefix(true);
+		const auto sent = time::steady_clock::now();
+		m_sent++;
+		m_outstanding++;
+		m_face.expressInterest(
+		    interest,
+		    [this, sent](const Interest &interest, const Data &data) {
+			    m_outstanding--;
+			    m_acked++;
+			    if (m_options.mode == Mode::ND_INFO) {
+				    m_latencies.push_back(
+				        static_cast<double>(
+				            (time::steady_clock::now() - sent).count()) /
+				        NS_PER_MS);
+			    }
+		    },
+		    [this](const Interest &interest, const lp::Nack &nack) {
+			    m_outstanding--;
+			    m_nacks++;
+		    },
+		    [this](const Interest &interest) {
+			    m_outstanding--;
+			    m_timeouts++;
+		    });
+	}
+
+	auto elapsedSeconds() const -> double {
+		return static_cast<double>(
+		           (time::steady_clock::now() - m_start).count()) /
+		       NS_PER_MS / MS_PER_S;
+	}
+
+	void tick() {
+		const auto now = time::steady_clock::now();
+		// Catch up to the rate, sending in bursts when it is above one per
+		// tick.
+		const double elapsed_s = elapsedSeconds();
+		const long due = std::min(
+		    m_options.count, static_cast<long>(elapsed_s * m_options.rate));
+		while (m_sent < due) {
+			sendOne(m_sent);
+			if (m_sent == m_options.count) {
+				m_all_sent = now;
+			}
+		}
+		pollAgent();
+		if (now >= m_next_report) {
+			m_next_report += REPORT_INTERVAL;
+			report();
+			requestStats("stats");
+		}
+		if (m_sent >= m_options.count &&
+		    (m_outstanding == 0 || now - m_all_sent > DRAIN_TIME)) {
+			finish();
+			return;
+		}
+		m_scheduler.schedule(TICK, [this] { tick(); });
+	}
+
+	void report() {
+		cout << "AH Loadgen: " << static_cast<long>(elapsedSeconds())
+		     << "s sent "
+		     << m_sent << " answered " << m_acked << " outstanding "
+		     << m_outstanding;
+		if (!m_agent_stats.empty()) {
+			const string handling = jsonObject(m_agent_stats, "handling");
+			cout << " | agent handling p50 " << jsonField(handling, "p50_us")
+			     << "us p99 " << jsonField(handling, "p99_us") << "us piers "
+			     << jsonField(m_agent_stats, "piers")
+			     << " commands in flight "
+			     << jsonField(m_agent_stats, "in_flight") << " (peak "
+			     << jsonField(m_agent_stats, "peak_in_flight")
+			     << ") retries pending "
+			     << jsonField(m_agent_stats, "retries_pending");
+		}
+		cout << endl;
+	}
+
+	void finish() {
+		requestStats("stats");
+		// Give the agent a moment to answer with its final numbers.
+		waitForAgent(time::steady_clock::now() + AGENT_WAIT);
+	}
+
+	void waitForAgent(time::steady_clock::time_point until) {
+		pollAgent();
+		if (m_agent_waiting && time::steady_clock::now() < until) {
+			m_scheduler.schedule(TICK, [this, until] { waitForAgent(until); });
+			return;
+		}
+		cout << summary() << endl;
+		if (m_options.depart) {
+			departAll();
+		}
+		m_scheduler.schedule(SHUTDOWN_DELAY, [this] { m_face.shutdown(); });
+	}
+
+	// Let the daemon remove the faces and routes it made for the run.
+	void departAll() {
+		long departed = 0;
+		for (size_t pier = 0; pier < m_announced.size(); pier++) {
+			if (!m_announced.at(pier)) {
+				continue;
+			}
+			Interest interest(announcementName(
+			    m_options.broadcast, "departure", static_cast<long>(pier)));
+			interest.setInterestLifetime(ANNOUNCEMENT_LIFETIME);
+			interest.setMustBeFresh(true);
+			interest.setCanBePrefix(true);
+			m_face.expressInterest(
+			    interest, [](const Interest &, const Data &) {},
+			    [](const Interest &, const lp::Nack &) {},
+			    [](const Interest &) {});
+			departed++;
+		}
+		cout << "AH Loadgen: Sent " << departed << " departures" << endl;
+	}
+
+	auto summary() const -> string {
+		const double seconds = elapsedSeconds();
+		std::vector<double> latencies = m_latencies;
+		std::sort(latencies.begin(), latencies.end());
+		double sum = 0;
+		for (auto latency : latencies) {
+			sum += latency;
+		}
+		stringstream json;
+		json << R"({"mode":")"
+		     << (m_options.mode == Mode::ARRIVAL ? "arrival" : "nd-info")
+		     << R"(","rate":)" << m_options.rate << R"(,"piers":)"
+		     << poolSize() << R"(,"sent":)" << m_sent << R"(,"seconds":)"
+		     << seconds << R"(,"answered":)" << m_acked << R"(,"nacks":)"
+		     << m_nacks << R"(,"timeouts":)" << m_timeouts
+		     << R"(,"answered_per_s":)"
+		     << (seconds > 0 ? static_cast<double>(m_acked) / seconds : 0.0);
+		if (m_options.mode == Mode::ND_INFO) {
+			json << R"(,"avg_ms":)"
+			     << (latencies.empty()
+			             ? 0.0
+			             : sum / static_cast<double>(latencies.size()))
+			     << R"(,"p50_ms":)" << percentile(latencies, 0.5)
+			     << R"(,"p90_ms":)" << percentile(latencies, 0.9)
+			     << R"(,"p99_ms":)" << percentile(latencies, 0.99)
+			     << R"(,"max_ms":)"
+			     << (latencies.empty() ? 0.0 : latencies.back());
+		}
+		json << R"(,"agent_handling":)"
+		     << (m_agent_stats.empty() ? "null"
+		                               : jsonObject(m_agent_stats, "handling"))
+		     << R"(,"agent":)"
+		     << (m_agent_stats.empty() ? "null" : m_agent_stats) << "}";
+		return json.str();
+	}
+
+	void connectAgent() {
+		struct sockaddr_un addr {};
+		m_agent = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_agent == -1) {
+			perror("AH Loadgen: socket");
+			return;
+		}
+		addr.sun_family = AF_UNIX;
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-array-to-pointer-decay)
+		strncpy(addr.sun_path, m_options.socketPath.c_str(),
+		        sizeof(addr.sun_path) - 1);
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+		if (connect(m_agent, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+			cout << "AH Loadgen: No agent at " << m_options.socketPath
+			     << ", only client side numbers are reported" << endl;
+			close(m_agent);
+			m_agent = -1;
+			return;
+		}
+		// The agent is polled from the send loop, never wait on it.
+		fcntl(m_agent, F_SETFL, fcntl(m_agent, F_GETFL) | O_NONBLOCK);
+	}
+
+	void requestStats(const string &command) {
+		if (m_agent == -1 || m_agent_waiting) {
+			return;
+		}
+		if (write(m_agent, command.c_str(), command.length()) == -1) {
+			perror("AH Loadgen: ERROR writing to agent");
+			return;
+		}
+		m_agent_waiting = true;
+	}
+
+	// Replies are NUL terminated.
+	void pollAgent() {
+		if (m_agent == -1 || !m_agent_waiting) {
+			return;
+		}
+		std::array<char, AGENT_BUF_LEN> buf{};
+		ssize_t rc = 0;
+		while ((rc = read(m_agent, buf.data(), buf.size())) > 0) {
+			m_agent_reply.append(buf.data(), rc);
+		}
+		const size_t end = m_agent_reply.find('\0');
+		if (end != string::npos) {
+			m_agent_stats = m_agent_reply.substr(0, end);
+			m_agent_reply.erase(0, end + 1);
+			m_agent_waiting = false;
+		}
+	}
+};
+
+auto main(int argc, char *argv[]) -> int {
+	LoadOptions options;
+	int opt = 0;
+	try {
+		while ((opt = getopt(argc, argv, "m:r:n:k:D:b:B:t:a:i:s:x")) != -1) {
+			const string arg = optarg != nullptr ? optarg : "";
+			if (opt == 'm') {
+				options.mode = arg == "info" ? Mode::ND_INFO : Mode::ARRIVAL;
+			} else if (opt == 'r') {
+				options.rate = std::stod(arg);
+			} else if (opt == 'n') {
+				options.count = std::stol(arg);
+			} else if (opt == 'k') {
+				options.prefixes = std::stol(arg);
+			} else if (opt == 'D') {
+				options.distribution =
+				    arg == "zipf" ? Distribution::ZIPF
+				                  : arg == "uniform" ? Distribution::UNIFORM
+				                                     : Distribution::SEQUENTIAL;
+			} else if (opt == 'b') {
+				options.base = Name(arg);
+			} else if (opt == 'B') {
+				options.broadcast = Name(arg);
+			} else if (opt == 't') {
+				options.target = Name(arg);
+			} else if (opt == 'a') {
+				in_addr ip{};
+				if (inet_pton(AF_INET, arg.c_str(), &ip) != 1) {
+					throw std::invalid_argument("bad address " + arg);
+				}
+				options.firstIp = ntohl(ip.s_addr);
+			} else if (opt == 'i') {
+				options.addresses = std::stol(arg);
+			} else if (opt == 's') {
+				options.socketPath = arg;
+			} else if (opt == 'x') {
+				options.depart = false;
+			} else {
+				optind = argc + 1;
+				break;
+			}
+		}
+	} catch (const std::logic_error &e) {
+		cout << "AH Loadgen: " << e.what() << endl;
+		optind = argc + 1;
+	}
+	if (optind != argc || options.rate <= 0 || options.count <= 0 ||
+	    options.prefixes < 0 ||
+	    (options.mode == Mode::ND_INFO && options.target.empty())) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		cout << "usage: " << argv[0]
+		     << " [-m arrival|info] [-t /daemon/prefix] [-r rate] [-n count]"
+		     << endl
+		     << "       [-k piers] [-D seq|uniform|zipf] [-b /base] "
+		        "[-B /ahnd]"
+		     << endl
+		     << "       [-a first ip] [-i addresses] [-s agent socket] [-x]"
+		     << endl;
+		cout << "    -m: arrival interests (multicast, reach every daemon "
+		        "on the segment,"
+		     << endl
+		     << "        throughput only) or nd-info interests to the daemon "
+		        "at -t only"
+		     << endl;
+		cout << "    -r: interests per second (100), -n: how many (1000)"
+		     << endl;
+		cout << "    -k: distinct synthetic piers (one per interest), -D: "
+		        "which pier each"
+		     << endl
+		     << "        interest announces" << endl;
+		cout << "    -a, -i: pier addresses (10.255.0.1 and 254 after it)"
+		     << endl;
+		cout << "    -x: keep the piers, do not send departures at the end"
+		     << endl;
+		return 1;
+	}
+	LoadGenerator generator(options);
+	generator.run();
+}
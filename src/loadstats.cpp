@@ -0,0 +1,133 @@
+#include "loadstats.h"
+#include "pinger.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+constexpr size_t MAX_LOAD_SAMPLES = 4096;
+constexpr double NS_PER_US = 1000.0;
+constexpr double NS_PER_MS = 1000000.0;
+
+// Counts one command as in flight for as long as it is alive.
+struct CommandTicket {
+	std::shared_ptr<LoadStats::Commands> commands;
+	time::steady_clock::time_point sent{time::steady_clock::now()};
+
+	explicit CommandTicket(std::shared_ptr<LoadStats::Commands> commands)
+	    : commands(std::move(commands)) {
+		this->commands->sent++;
+		this->commands->inFlight++;
+		this->commands->peakInFlight = std::max(
+		    this->commands->peakInFlight, this->commands->inFlight);
+	}
+	~CommandTicket() {
+		commands->inFlight--;
+		commands->latencyMs.add(
+		    static_cast<double>((time::steady_clock::now() - sent).count()) /
+		    NS_PER_MS);
+	}
+	CommandTicket(const CommandTicket &) = delete;
+	auto operator=(const CommandTicket &) -> CommandTicket & = delete;
+};
+
+void LoadStats::Samples::add(double value) {
+	if (values.size() < MAX_LOAD_SAMPLES) {
+		values.push_back(value);
+	} else {
+		values.at(next) = value;
+	}
+	next = (next + 1) % MAX_LOAD_SAMPLES;
+}
+
+auto LoadStats::Samples::json(const string &unit) const -> string {
+	std::vector<double> sorted = values;
+	std::sort(sorted.begin(), sorted.end());
+	double sum = 0;
+	for (auto value : sorted) {
+		sum += value;
+	}
+	stringstream out;
+	out << R"({"samples":)" << sorted.size() << R"(,"avg_)" << unit
+	    << R"(":)"
+	    << (sorted.empty() ? 0.0 : sum / static_cast<double>(sorted.size()))
+	    << R"(,"p50_)" << unit << R"(":)" << percentile(sorted, 0.5)
+	    << R"(,"p90_)" << unit << R"(":)" << percentile(sorted, 0.9)
+	    << R"(,"p99_)" << unit << R"(":)" << percentile(sorted, 0.99)
+	    << R"(,"max_)" << unit << R"(":)"
+	    << (sorted.empty() ? 0.0 : sorted.back()) << "}";
+	return out.str();
+}
+
+LoadStats::LoadStats() : m_commands(make_shared<Commands>()) {}
+
+void LoadStats::announcement(Announcement kind,
+                             time::nanoseconds handling) {
+	m_announcements.at(static_cast<size_t>(kind))++;
+	m_handle_us.add(static_cast<double>(handling.count()) / NS_PER_US);
+}
+
+void LoadStats::provisioned(time::nanoseconds took) {
+	m_provision_ms.add(static_cast<double>(took.count()) / NS_PER_MS);
+}
+
+auto LoadStats::command() -> std::shared_ptr<void> {
+	return make_shared<CommandTicket>(m_commands);
+}
+
+void LoadStats::keepalives(size_t sent, size_t passive) {
+	m_keepalives_sent += sent;
+	m_keepalives_passive += passive;
+}
+
+void LoadStats::rejected(Verdict verdict) {
+	if (verdict == Verdict::THROTTLED) {
+		m_throttled++;
+	} else if (verdict == Verdict::OVERLOADED) {
+		m_overloaded++;
+	} else if (verdict == Verdict::FULL) {
+		m_full++;
+	}
+}
+
+void LoadStats::reset() {
+	m_announcements.fill(0);
+	m_throttled = 0;
+	m_overloaded = 0;
+	m_full = 0;
+	m_keepalives_sent = 0;
+	m_keepalives_passive = 0;
+	m_handle_us = Samples();
+	m_provision_ms = Samples();
+	m_commands->sent = 0;
+	m_commands->peakInFlight = m_commands->inFlight;
+	m_commands->latencyMs = Samples();
+}
+
+auto LoadStats::json(size_t piers, size_t retries_pending,
+                     size_t retries_queued) const -> string {
+	stringstream out;
+	out << R"({"arrivals":)"
+	    << m_announcements.at(static_cast<size_t>(Announcement::ARRIVAL))
+	    << R"(,"nd_info":)"
+	    << m_announcements.at(static_cast<size_t>(Announcement::ND_INFO))
+	    << R"(,"departures":)"
+	    << m_announcements.at(static_cast<size_t>(Announcement::DEPARTURE))
+	    << R"(,"throttled":)" << m_throttled << R"(,"overloaded":)"
+	    << m_overloaded << R"(,"full":)" << m_full << R"(,"piers":)" << piers
+	    << R"(,"handling":)" << m_handle_us.json("us") << R"(,"provisioning":)"
+	    << m_provision_ms.json("ms") << R"(,"commands":{"sent":)"
+	    << m_commands->sent << R"(,"in_flight":)" << m_commands->inFlight
+	    << R"(,"peak_in_flight":)" << m_commands->peakInFlight
+	    << R"(,"latency":)" << m_commands->latencyMs.json("ms")
+	    << R"(},"keepalives":{"sent":)" << m_keepalives_sent
+	    << R"(,"passive":)" << m_keepalives_passive
+	    << R"(},"retries_pending":)" << retries_pending
+	    << R"(,"retries_queued":)" << retries_queued << "}";
+	return out.str();
+}
+} // namespace ahnd
@@ -0,0 +1,63 @@
+#ifndef AHND_LOADSTATS_H
+#define AHND_LOADSTATS_H
+
+#include "admission.h"
+
+namespace ahnd {
+
+enum class Announcement { ARRIVAL, ND_INFO, DEPARTURE };
+
+// How fast announcements are absorbed: how long handling one takes, how long
+// a new pier waits for its face and route, and how many NFD commands are
+// queued up behind each other.  Latencies keep the most recent samples only.
+class LoadStats {
+  public:
+	struct Samples {
+		std::vector<double> values;
+		size_t next{0};
+
+		void add(double value);
+		// Count, average, percentiles and max as JSON fields.
+		auto json(const std::string &unit) const -> std::string;
+	};
+	struct Commands {
+		uint64_t sent{0};
+		size_t inFlight{0};
+		size_t peakInFlight{0};
+		Samples latencyMs;
+	};
+
+  private:
+	std::array<uint64_t, 3> m_announcements{};
+	Samples m_handle_us;
+	Samples m_provision_ms;
+	std::shared_ptr<Commands> m_commands;
+	uint64_t m_keepalives_sent{0};
+	uint64_t m_keepalives_passive{0};
+	uint64_t m_throttled{0};
+	uint64_t m_overloaded{0};
+	uint64_t m_full{0};
+
+  public:
+	LoadStats();
+	void announcement(Announcement kind, ndn::time::nanoseconds handling);
+	// A new pier's face and route are up, took is from its first
+	// announcement.
+	void provisioned(ndn::time::nanoseconds took);
+	// Capture the result in an NFD command's callbacks, the command counts
+	// as in flight until they are dropped (answered, timed out or
+	// cancelled).
+	auto command() -> std::shared_ptr<void>;
+	// A keepalive round probed some piers, the rest had shown signs of life
+	// on their own (passive liveness).
+	void keepalives(size_t sent, size_t passive);
+	// An announcement Admission turned away.
+	void rejected(Verdict verdict);
+	// Counters and latencies start over, commands in flight stay counted.
+	void reset();
+	auto json(size_t piers, size_t retries_pending, size_t retries_queued) const
+	    -> std::string;
+};
+} // namespace ahnd
+
+#endif // AHND_LOADSTATS_H
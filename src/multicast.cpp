@@ -15,9 +15,11 @@ const uint64_t DISCOVERY_ROUTE_COST(0);
 const time::milliseconds DISCOVERY_ROUTE_EXPIRATION = 30_s;
 
 MulticastInterest::MulticastInterest(
-    Face &face, std::shared_ptr<nfd::Controller> controller, Name prefix)
+    Face &face, std::shared_ptr<nfd::Controller> controller, Name prefix,
+    bool may_enable_local_fields)
     : m_face(face), m_controller(std::move(controller)),
-      m_prefix(std::move(prefix)) {
+      m_prefix(std::move(prefix)),
+      m_may_enable_local_fields(may_enable_local_fields) {
 	m_ready = false;
 	m_error = false;
 }
@@ -25,6 +27,32 @@ MulticastInterest::MulticastInterest(
 void MulticastInterest::reset() {
 	m_ready = false;
 	m_error = false;
+	if (m_local_fields || !m_may_enable_local_fields) {
+		queryFaces();
+	} else {
+		enableLocalFields();
+	}
+}
+
+void MulticastInterest::enableLocalFields() {
+	// No face id, the update applies to the face the command arrives on.
+	nfd::ControlParameters parameters;
+	parameters.setFlagBit(nfd::BIT_LOCAL_FIELDS_ENABLED, true);
+	m_controller->start<nfd::FaceUpdateCommand>(
+	    parameters,
+	    [this](const nfd::ControlParameters &_) {
+		    m_local_fields = true;
+		    queryFaces();
+	    },
+	    [this](const nfd::ControlResponse &resp) {
+		    // Still usable, announcements just go out on every face.
+		    cout << "AHND (Multicast): Error " << to_string(resp.getCode())
+		         << " when enabling local fields: " << resp.getText() << endl;
+		    queryFaces();
+	    });
+}
+
+void MulticastInterest::queryFaces() {
 	nfd::FaceQueryFilter filter;
 	filter.setLinkType(nfd::LINK_TYPE_MULTI_ACCESS);
 
@@ -51,6 +79,17 @@ void MulticastInterest::expressInterest(const Interest &interest,
 	}
 }
 
+void MulticastInterest::expressInterest(uint64_t face_id,
+                                        const Interest &interest,
+                                        const DataCallback &afterSatisfied,
+                                        const NackCallback &afterNacked,
+                                        const TimeoutCallback &afterTimeout) {
+	if (m_local_fields) {
+		interest.setTag(make_shared<lp::NextHopFaceIdTag>(face_id));
+	}
+	expressInterest(interest, afterSatisfied, afterNacked, afterTimeout);
+}
+
 void MulticastInterest::requestReady() {
 	m_ready = true;
 	m_error = false;
@@ -89,6 +128,7 @@ void MulticastInterest::registerMultiPrefix(
 		cout << "AHND (Multicast): No multi-access m_faces available" << endl;
 		m_error = true;
 	}
+	m_faces = dataset;
 
 	int n_regs = dataset.size();
 	std::shared_ptr<int> n_reg_success = std::make_shared<int>(0);
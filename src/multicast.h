@@ -16,7 +16,15 @@ class MulticastInterest {
 	ndn::Name m_prefix;
 	bool m_ready;
 	bool m_error;
+	// NFD honours the NextHopFaceId of our interests only with local fields
+	// enabled on our face.  Only turned on where we may change the face's
+	// flags, a face borrowed from an application is left alone.
+	bool m_local_fields{false};
+	bool m_may_enable_local_fields;
+	std::vector<ndn::nfd::FaceStatus> m_faces;
 
+	void enableLocalFields();
+	void queryFaces();
 	void requestReady();
 	void setStrategy();
 	void afterReg(int n_reg_success);
@@ -25,14 +33,27 @@ class MulticastInterest {
   public:
 	MulticastInterest(ndn::Face &face,
 	                  std::shared_ptr<ndn::nfd::Controller> controller,
-	                  ndn::Name prefix);
+	                  ndn::Name prefix, bool may_enable_local_fields);
 	void reset();
+	// Takes effect from the next reset().
+	void setMayEnableLocalFields(bool enabled) {
+		m_may_enable_local_fields = enabled;
+	}
 	auto isReady() const { return m_ready; }
 	auto isError() const { return m_error; }
+	// Multi-access faces the prefix was registered on.
+	auto faces() const -> const std::vector<ndn::nfd::FaceStatus> & {
+		return m_faces;
+	}
 	void expressInterest(const ndn::Interest &interest,
 	                     const ndn::DataCallback &afterSatisfied,
 	                     const ndn::NackCallback &afterNacked,
 	                     const ndn::TimeoutCallback &afterTimeout);
+	// Send only out of face_id instead of letting the strategy pick.
+	void expressInterest(uint64_t face_id, const ndn::Interest &interest,
+	                     const ndn::DataCallback &afterSatisfied,
+	                     const ndn::NackCallback &afterNacked,
+	                     const ndn::TimeoutCallback &afterTimeout);
 };
 } // namespace ahnd
 
@@ -1,4 +1,5 @@
 #include "ahclient.h"
+#include "config.h"
 
 #include <csignal>
 #include <iostream>
@@ -16,15 +17,12 @@ using namespace ndn;
 using namespace ahnd;
 using namespace std;
 
-const Name BROADCAST_PREFIX("/ahnd");
-constexpr int KEEPALIVE_SECONDS = 300;
-constexpr int DEFAULT_PORT = 6363;
-constexpr int LOOP_MS = 500;
 constexpr int SHUTDOWN_DELAY_MS = 5000;
 constexpr int CLIENT_BUF_LEN = 100;
 constexpr int CLIENT_SELECT_USEC = 100;
 constexpr int CLIENT_LISTEN_QUEUE = 5;
 constexpr int MAX_CLIENTS = 5;
+constexpr uint64_t BYTES_PER_MEGABYTE = 1024 * 1024;
 
 namespace {
 // In the GNUC Library, sig_atomic_t is a typedef for int,
@@ -65,14 +63,43 @@ auto clientListen(const string &socket_path) -> int {
 	return fd;
 }
 
+auto ip6String(const in6_addr &ip) -> std::string {
+	std::array<char, INET6_ADDRSTRLEN> buf{0};
+	inet_ntop(AF_INET6, &ip, buf.data(), buf.size());
+	return buf.data();
+}
+
+// Replies to agent clients are NUL terminated.
+void writeClient(int cl, const std::string &message) {
+	if (write(cl, message.c_str(), message.length() + 1) == -1) {
+		perror("AH Client: ERROR writing to client");
+	}
+}
+
+void writePrefixes(std::ostream &out, const std::vector<ndn::Name> &prefixes) {
+	out << R"(,"prefixes":[)";
+	for (size_t i = 0; i < prefixes.size(); i++) {
+		if (i > 0) {
+			out << ",";
+		}
+		out << '"' << prefixes.at(i) << '"';
+	}
+	out << "]";
+}
+
 class Program {
   public:
-	explicit Program(const ndn::Name &prefix) {
+	Program(const ndn::Name &prefix, const std::vector<ndn::Name> &extra,
+	        bool gossip, bool ether, size_t delegates, Config config)
+	    : m_gossip(gossip), m_config(std::move(config)) {
 		// Init client
-		m_client =
-		    make_unique<AHClient>(prefix, BROADCAST_PREFIX, DEFAULT_PORT);
-
-		m_scheduler = make_unique<Scheduler>(m_client->face().getIoService());
+		m_client = make_unique<AHClient>(prefix, m_config.broadcastPrefix(),
+		                                 m_config.port(), m_config.timing());
+		m_client->setEtherFaces(ether);
+		m_client->setDelegates(delegates);
+		for (const auto &extra_prefix : extra) {
+			m_client->addPrefix(extra_prefix);
+		}
 	}
 
 	// TODO: remove face on SIGINT, SIGTERM
@@ -98,8 +125,8 @@ class Program {
 		}
 
 		m_client->registerPrefixes();
-		m_scheduler->schedule(time::seconds(KEEPALIVE_SECONDS),
-		                      [this] { keepaliveLoop(); });
+		scheduleKeepalive();
+		scheduleGossip();
 		std::array<int, MAX_CLIENTS> client_fds{};
 		for (int i = 0; i < MAX_CLIENTS; i++) {
 			client_fds.at(i) = -1;
@@ -107,7 +134,7 @@ class Program {
 		cout << "AH Client: Listening for agent clients on " << socket_path
 		     << endl;
 		while (do_shutdown == 0) {
-			m_client->processEvents(LOOP_MS);
+			m_client->processEvents(m_config.timing().loopMs);
 
 			fd_set rfds;
 			struct timeval tv {};
@@ -204,7 +231,15 @@ class Program {
 								    << R"(,"faceId":0)"
 								    << R"(,"prefix":")" << m_client->getPrefix()
 								    << R"(","ip":")" << ip_str << R"(","port":)"
-								    << m_client->getPort() << "}";
+								    << m_client->getPort();
+								if (m_client->hasIp6()) {
+									pierstr << R"(,"ip6":")"
+									        << ip6String(m_client->getIp6())
+									        << R"(")";
+								}
+								writePrefixes(pierstr,
+								              m_client->getExtraPrefixes());
+								pierstr << "}";
 								m_client->visitPiers([&pierstr](
 								                         const DBEntry &pier) {
 									pierstr << "," << endl << "    ";
@@ -214,7 +249,32 @@ class Program {
 									        << R"(,"prefix":")" << pier.prefix
 									        << R"(","ip":")" << ip_str
 									        << R"(","port":)" << pier.port
-									        << "}";
+									        << R"(,"rtt_ms":)" << pier.srttMs
+									        << R"(,"loss":)" << pier.lossRate
+									        << R"(,"cost":)" << pier.cost
+									        << R"(,"state":")"
+									        << pierStateName(pier.state)
+									        << R"(")"
+									        << R"(,"link":")"
+									        << linkClassName(pier.link)
+									        << (pier.lossy ? "+lossy" : "")
+									        << R"(")"
+									        << R"(,"family":")"
+									        << (!pier.mac.empty()
+									                ? "ether"
+									                : pier.useIp6 ? "udp6"
+									                              : "udp4")
+									        << R"(")";
+									if (!pier.mac.empty()) {
+										pierstr << R"(,"mac":")" << pier.mac
+										        << R"(")";
+									}
+									if (pier.hasIp6) {
+										pierstr << R"(,"ip6":")"
+										        << ip6String(pier.ip6) << R"(")";
+									}
+									writePrefixes(pierstr, pier.extraPrefixes);
+									pierstr << "}";
 								});
 								pierstr << endl;
 								pierstr << "]" << endl;
@@ -225,6 +285,149 @@ class Program {
 									client_fds.at(i) = -1;
 									close(cl);
 								}
+							} else if (command == "ping") {
+								// ping <pier id, 0 for all> [count]
+								//      [interval ms] [payload bytes]
+								PingOptions options;
+								long pier = -1;
+								try {
+									if (results.size() > 1) {
+										pier = std::stol(results[1]);
+									}
+									if (results.size() > 2) {
+										options.count = std::stol(results[2]);
+									}
+									if (results.size() > 3) {
+										options.intervalMs =
+										    std::stol(results[3]);
+									}
+									if (results.size() > 4) {
+										options.payloadSize =
+										    std::stoul(results[4]);
+									}
+								} catch (const std::logic_error &e) {
+									pier = -1;
+								}
+								if (pier < 0) {
+									writeClient(cl,
+									            "ERROR ping requires a pier id "
+									            "(0 for all) and numeric "
+									            "options");
+									continue;
+								}
+								m_client->pingPiers(
+								    pier, options,
+								    [cl](const string &json) {
+									    writeClient(cl, json);
+								    },
+								    [cl](const string &error) {
+									    writeClient(cl, "ERROR " + error);
+								    });
+							} else if (command == "bench") {
+								// bench <pier id> [megabytes] [window]
+								//       [aimd|fixed]
+								BenchOptions options;
+								long pier = -1;
+								try {
+									if (results.size() > 1) {
+										pier = std::stol(results[1]);
+									}
+									if (results.size() > 2) {
+										options.bytes =
+										    std::stoull(results[2]) *
+										    BYTES_PER_MEGABYTE;
+									}
+									if (results.size() > 3) {
+										options.window = std::stod(results[3]);
+									}
+								} catch (const std::logic_error &e) {
+									pier = -1;
+								}
+								if (results.size() > 4) {
+									options.aimd = results[4] != "fixed";
+								}
+								if (pier <= 0) {
+									writeClient(cl,
+									            "ERROR bench requires a pier "
+									            "id and numeric options");
+									continue;
+								}
+								m_client->benchPier(
+								    pier, options,
+								    [cl](const string &json) {
+									    writeClient(cl, json);
+								    },
+								    [cl](const string &error) {
+									    writeClient(cl, "ERROR " + error);
+								    });
+							} else if (command == "stats") {
+								// stats [reset]
+								writeClient(cl, m_client->getStats());
+								if (results.size() > 1 &&
+								    results[1] == "reset") {
+									m_client->resetStats();
+								}
+							} else if (command == "trace") {
+								// trace [clear|on|off]
+								const string option =
+								    results.size() > 1 ? results[1] : "";
+								if (option == "on" || option == "off") {
+									m_client->setTracing(option == "on");
+									writeClient(cl, R"({"tracing":)" +
+									                    string(option == "on"
+									                               ? "true"
+									                               : "false") +
+									                    "}");
+								} else {
+									writeClient(cl, m_client->getTrace());
+									if (option == "clear") {
+										m_client->clearTrace();
+									}
+								}
+							} else if (command == "delegates") {
+								writeClient(cl, m_client->getElection());
+							} else if (command == "get") {
+								// get [key]
+								try {
+									writeClient(
+									    cl, results.size() > 1
+									            ? R"({")" + results[1] +
+									                  R"(":")" +
+									                  m_config.get(results[1]) +
+									                  R"("})"
+									            : m_config.json());
+								} catch (const std::invalid_argument &e) {
+									writeClient(cl, string("ERROR ") +
+									                    e.what());
+								}
+							} else if (command == "set") {
+								// set <key> <value>
+								if (results.size() != 3) {
+									writeClient(cl, "ERROR set requires a "
+									                "key and a value");
+									continue;
+								}
+								try {
+									m_config.set(results[1], results[2],
+									             true);
+									applyTiming();
+									writeClient(cl, m_config.json());
+								} catch (const std::invalid_argument &e) {
+									writeClient(cl, string("ERROR ") +
+									                    e.what());
+								}
+							} else if (command == "reload") {
+								const auto errors = m_config.reload();
+								applyTiming();
+								if (errors.empty()) {
+									writeClient(cl, m_config.json());
+								} else {
+									string message = "ERROR";
+									for (const auto &error : errors) {
+										message += " " + error + ";";
+									}
+									writeClient(cl, message);
+								}
 							} else if (command == "exit") {
 								cout << "AH Client: closed client at client "
 								        "request"
@@ -297,26 +500,129 @@ class Program {
 
 	void keepaliveLoop() {
 		m_client->sendKeepAliveInterest();
-		m_scheduler->schedule(time::seconds(KEEPALIVE_SECONDS),
-		                      [this] { keepaliveLoop(); });
+		scheduleKeepalive();
+	}
+
+	void gossipLoop() {
+		m_client->sendGossip();
+		scheduleGossip();
+	}
+
+	// Reassigning the scoped ids cancels the timers already running.
+	void scheduleKeepalive() {
+		m_keepalive_event = m_client->scheduler().schedule(
+		    time::seconds(m_config.timing().keepaliveSeconds),
+		    [this] { keepaliveLoop(); });
+	}
+
+	void scheduleGossip() {
+		if (m_gossip) {
+			m_gossip_event = m_client->scheduler().schedule(
+			    time::seconds(m_config.timing().gossipSeconds),
+			    [this] { gossipLoop(); });
+		}
+	}
+
+	// Hand the settings to the client and restart the loops whose period
+	// changed, a shorter period takes effect now rather than after the old
+	// one runs out.
+	void applyTiming() {
+		const Timing &timing = m_config.timing();
+		m_client->setTiming(timing);
+		if (timing.keepaliveSeconds != m_keepalive_seconds) {
+			m_keepalive_seconds = timing.keepaliveSeconds;
+			scheduleKeepalive();
+		}
+		if (timing.gossipSeconds != m_gossip_seconds) {
+			m_gossip_seconds = timing.gossipSeconds;
+			scheduleGossip();
+		}
 	}
 
   private:
+	bool m_gossip;
+	Config m_config;
+	long m_keepalive_seconds{m_config.timing().keepaliveSeconds};
+	long m_gossip_seconds{m_config.timing().gossipSeconds};
 	std::unique_ptr<AHClient> m_client;
-	std::unique_ptr<Scheduler> m_scheduler;
+	scheduler::ScopedEventId m_keepalive_event;
+	scheduler::ScopedEventId m_gossip_event;
 };
 
 auto main(int argc, char *argv[]) -> int {
 	// Suppress the pointer arithmetic lint on two lines, this is just how you
 	// deal with arguments...
-	if (argc < 2) {
+	bool gossip = false;
+	bool ether = false;
+	size_t delegates = 0;
+	Config config;
+	int opt = 0;
+	while ((opt = getopt(argc, argv, "ged:c:")) != -1) {
+		if (opt == 'g') {
+			gossip = true;
+		} else if (opt == 'e') {
+			ether = true;
+		} else if (opt == 'd') {
+			const string count = optarg;
+			size_t used = 0;
+			long number = -1;
+			try {
+				number = std::stol(count, &used);
+			} catch (const std::logic_error &e) {
+				used = 0;
+			}
+			if (used == 0 || used != count.size() || number < 0) {
+				cout << "AH Client: -d takes a count of delegates" << endl;
+				optind = argc + 1;
+				break;
+			}
+			delegates = static_cast<size_t>(number);
+			// Everyone but the delegates learns routes by gossip.
+			gossip = delegates > 0 || gossip;
+		} else if (opt == 'c') {
+			const auto errors = config.load(optarg, false);
+			for (const auto &error : errors) {
+				cout << "AH Client: Config " << error << endl;
+			}
+			if (!errors.empty()) {
+				return 1;
+			}
+		} else {
+			optind = argc + 1;
+			break;
+		}
+	}
+	if (optind >= argc) {
 		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-		cout << "usage: " << argv[0] << "/prefix" << endl;
-		cout << "    /prefix: the ndn name for this client" << endl;
+		cout << "usage: " << argv[0]
+		     << " [-g] [-e] [-d count] [-c config] /prefix [/prefix ...]"
+		     << endl;
+		cout << "    -g: gossip pier lists with piers to learn routes to "
+		        "nodes beyond"
+		     << endl
+		     << "        this multicast domain" << endl;
+		cout << "    -e: use Ethernet faces for piers on the same link" << endl;
+		cout << "    -d: elect count delegates per segment and keep faces "
+		        "only to them"
+		     << endl
+		     << "        (implies -g)" << endl;
+		cout << "    -c: read settings from a key = value file, the agent "
+		        "reload command"
+		     << endl
+		     << "        re-reads it" << endl;
+		cout << "    /prefix: the ndn name for this client, any additional"
+		     << endl
+		     << "             prefixes are advertised along with it" << endl;
 		return 1;
 	}
 
+	std::vector<ndn::Name> extra;
+	for (int i = optind + 1; i < argc; i++) {
+		// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+		extra.emplace_back(argv[i]);
+	}
 	// NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-	Program program(argv[1]);
+	Program program(argv[optind], extra, gossip, ether, delegates,
+	                std::move(config));
 	program.loop();
 }
@@ -0,0 +1,110 @@
+#include "netlink.h"
+
+#include <iostream>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace ahnd {
+
+NetlinkMonitor::NetlinkMonitor(boost::asio::io_service &io,
+                               ChangeCallback callback)
+    : m_socket(io), m_callback(std::move(callback)) {
+	int fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (fd == -1) {
+		perror("AHND (Netlink): socket");
+		return;
+	}
+	struct sockaddr_nl addr {};
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+		perror("AHND (Netlink): bind");
+		close(fd);
+		return;
+	}
+	m_socket.assign(fd);
+	asyncRead();
+}
+
+NetlinkMonitor::~NetlinkMonitor() {
+	boost::system::error_code error;
+	m_socket.close(error);
+}
+
+void NetlinkMonitor::asyncRead() {
+	m_socket.async_read_some(
+	    boost::asio::buffer(m_buffer),
+	    [this](const boost::system::error_code &error, size_t len) {
+		    handleRead(error, len);
+	    });
+}
+
+void NetlinkMonitor::requestDump() {
+	struct {
+		nlmsghdr header;
+		ifaddrmsg body;
+	} request{};
+	request.header.nlmsg_len = sizeof(request);
+	request.header.nlmsg_type = RTM_GETADDR;
+	// NOLINTNEXTLINE(hicpp-signed-bitwise)
+	request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	request.body.ifa_family = AF_UNSPEC;
+	if (send(m_socket.native_handle(), &request, sizeof(request), 0) == -1) {
+		perror("AHND (Netlink): dump request");
+		// Rescan anyway, that is all the dump would lead to.
+		m_callback();
+	}
+}
+
+void NetlinkMonitor::handleRead(const boost::system::error_code &error,
+                                size_t len) {
+	if (error == boost::asio::error::operation_aborted) {
+		return;
+	}
+	if (error == boost::asio::error::no_buffer_space) {
+		// The kernel dropped events when our socket buffer overflowed,
+		// start over from a full dump.
+		cout << "AHND (Netlink): Events lost, resyncing" << endl;
+		requestDump();
+		asyncRead();
+		return;
+	}
+	if (error == boost::asio::error::interrupted ||
+	    error == boost::asio::error::try_again) {
+		asyncRead();
+		return;
+	}
+	if (error) {
+		cout << "AHND (Netlink): Read error " << error.message()
+		     << ", no longer watching interfaces" << endl;
+		return;
+	}
+	bool changed = false;
+	// The netlink macros do pointer arithmetic on the buffer.
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+	auto *nh = reinterpret_cast<nlmsghdr *>(m_buffer.data());
+	auto remaining = static_cast<unsigned int>(len);
+	// NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast,hicpp-signed-bitwise)
+	for (; NLMSG_OK(nh, remaining); nh = NLMSG_NEXT(nh, remaining)) {
+		switch (nh->nlmsg_type) {
+		case RTM_NEWADDR:
+		case RTM_DELADDR:
+		case RTM_NEWLINK:
+		case RTM_DELLINK:
+			changed = true;
+			break;
+		default:
+			break;
+		}
+	}
+	if (changed) {
+		m_callback();
+	}
+	asyncRead();
+}
+} // namespace ahnd
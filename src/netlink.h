@@ -0,0 +1,36 @@
+#ifndef AHND_NETLINK_H
+#define AHND_NETLINK_H
+
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+namespace ahnd {
+
+constexpr size_t NETLINK_BUF_SIZE = 8192;
+
+// Watches rtnetlink for address and link changes and calls back when one is
+// seen.  Events come in bursts so callers should coalesce.
+class NetlinkMonitor {
+  public:
+	using ChangeCallback = std::function<void()>;
+
+  private:
+	boost::asio::posix::stream_descriptor m_socket;
+	std::array<uint8_t, NETLINK_BUF_SIZE> m_buffer{};
+	ChangeCallback m_callback;
+
+	void asyncRead();
+	// Ask for all addresses again, the replies come in as RTM_NEWADDR.
+	void requestDump();
+	void handleRead(const boost::system::error_code &error, size_t len);
+
+  public:
+	NetlinkMonitor(boost::asio::io_service &io, ChangeCallback callback);
+	~NetlinkMonitor();
+	NetlinkMonitor(const NetlinkMonitor &) = delete;
+	auto operator=(const NetlinkMonitor &) -> NetlinkMonitor & = delete;
+	auto isActive() const -> bool { return m_socket.is_open(); }
+};
+} // namespace ahnd
+
+#endif // AHND_NETLINK_H
@@ -3,11 +3,18 @@
 
 enum NFD_STATUS_CODE { OK = 200, FACE_EXISTS = 409 };
 
+enum NFD_FACE_PERSISTENCY {
+	PERSISTENCY_PERSISTENT = 0,
+	PERSISTENCY_ON_DEMAND = 1,
+	PERSISTENCY_PERMANENT = 2,
+};
+
 enum NFD_COMMAND_TLV_TYPE {
 	CONTROL_PARAMETERS = 0x68,
 	FACE_ID = 0x69,
 	URI = 0x72,
 	LOCAL_URI = 0x81,
+	FACE_PERSISTENCY = 0x85,
 	ORIGIN = 0x6f,
 	COST = 0x6a,
 	CAPACITY = 0x83,
@@ -0,0 +1,82 @@
+#include "pierlist.h"
+#include "ahnd-tlv.h"
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+// Bound what a single pier can make us process per page.
+constexpr size_t MAX_ENTRIES = 256;
+// The list's own type and length, and its version, offset and next page
+// numbers at their largest.
+constexpr size_t LIST_OVERHEAD = 4 + 3 * 10;
+
+static auto entryBlock(const PierListEntry &entry) -> Block {
+	auto block = makeEmptyBlock(PIER_LIST_ENTRY);
+	block.push_back(entry.prefix.wireEncode());
+	block.push_back(makeNonNegativeIntegerBlock(PIER_LIST_HOPS, entry.hops));
+	block.encode();
+	return block;
+}
+
+PierList::PierList(uint64_t version, std::vector<PierListEntry> entries)
+    : m_version(version), m_entries(std::move(entries)) {}
+
+PierList::PierList(const Block &block) {
+	block.parse();
+	m_version = readNonNegativeInteger(block.get(PIER_LIST_VERSION));
+	for (const auto &element : block.elements()) {
+		if (element.type() == PIER_LIST_OFFSET) {
+			m_offset = readNonNegativeInteger(element);
+		} else if (element.type() == PIER_LIST_NEXT) {
+			m_next = readNonNegativeInteger(element);
+		}
+		if (element.type() != PIER_LIST_ENTRY) {
+			continue;
+		}
+		if (m_entries.size() >= MAX_ENTRIES) {
+			break;
+		}
+		element.parse();
+		m_entries.push_back(
+		    {Name(element.get(tlv::Name)),
+		     readNonNegativeInteger(element.get(PIER_LIST_HOPS))});
+	}
+}
+
+auto PierList::page(uint64_t version, const std::vector<PierListEntry> &entries,
+                    size_t offset, size_t max_size) -> PierList {
+	PierList list(version, {});
+	list.m_offset = offset;
+	size_t size = LIST_OVERHEAD;
+	size_t i = offset;
+	for (; i < entries.size() && list.m_entries.size() < MAX_ENTRIES; i++) {
+		size += entryBlock(entries.at(i)).size();
+		if (size > max_size && !list.m_entries.empty()) {
+			break;
+		}
+		list.m_entries.push_back(entries.at(i));
+	}
+	list.m_next = i < entries.size() ? i : 0;
+	return list;
+}
+
+auto PierList::wireEncode() const -> Block {
+	auto block = makeEmptyBlock(PIER_LIST);
+	block.push_back(makeNonNegativeIntegerBlock(PIER_LIST_VERSION, m_version));
+	// Left out of a list that fits one page.
+	if (m_offset != 0) {
+		block.push_back(
+		    makeNonNegativeIntegerBlock(PIER_LIST_OFFSET, m_offset));
+	}
+	if (m_next != 0) {
+		block.push_back(makeNonNegativeIntegerBlock(PIER_LIST_NEXT, m_next));
+	}
+	for (const auto &entry : m_entries) {
+		block.push_back(entryBlock(entry));
+	}
+	block.encode();
+	return block;
+}
+} // namespace ahnd
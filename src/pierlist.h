@@ -0,0 +1,44 @@
+#ifndef AHND_PIERLIST_H
+#define AHND_PIERLIST_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+namespace ahnd {
+
+struct PierListEntry {
+	ndn::Name prefix;
+	// Distance from the node that sent the list, its direct piers are 1.
+	uint64_t hops;
+};
+
+// Versioned list of the prefixes a node can reach, exchanged between piers
+// by gossip.  A list with no entries and the version the requester already
+// has means "not modified".  A list too long for one packet goes out in
+// pages, each says where in the whole list it starts and where the next one
+// does (0 on the last page).
+class PierList {
+  private:
+	uint64_t m_version;
+	uint64_t m_offset{0};
+	uint64_t m_next{0};
+	std::vector<PierListEntry> m_entries;
+
+  public:
+	PierList(uint64_t version, std::vector<PierListEntry> entries);
+	explicit PierList(const ndn::Block &block);
+	// The page of entries starting at offset, as many as encode in max_size
+	// bytes (but at least one).
+	static auto page(uint64_t version,
+	                 const std::vector<PierListEntry> &entries, size_t offset,
+	                 size_t max_size) -> PierList;
+	auto version() const -> uint64_t { return m_version; }
+	auto offset() const -> uint64_t { return m_offset; }
+	auto next() const -> uint64_t { return m_next; }
+	auto entries() const -> const std::vector<PierListEntry> & {
+		return m_entries;
+	}
+	auto wireEncode() const -> ndn::Block;
+};
+} // namespace ahnd
+
+#endif // AHND_PIERLIST_H
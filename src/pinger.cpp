@@ -0,0 +1,117 @@
+#include "pinger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+constexpr auto PING_LIFETIME = 2_s;
+constexpr double US_PER_MS = 1000.0;
+
+auto percentile(const std::vector<double> &sorted, double p) -> double {
+	if (sorted.empty()) {
+		return 0;
+	}
+	auto rank = static_cast<size_t>(
+	    std::ceil(p * static_cast<double>(sorted.size())));
+	return sorted.at(std::max<size_t>(rank, 1) - 1);
+}
+
+Pinger::Pinger(Face &face, Scheduler &scheduler,
+               std::vector<PingTarget> targets, PingOptions options,
+               PingDoneCallback done)
+    : m_face(face), m_scheduler(scheduler), m_targets(std::move(targets)),
+      m_options(options), m_done(std::move(done)),
+      m_results(m_targets.size()) {}
+
+void Pinger::start() { sendRound(0); }
+
+void Pinger::sendRound(long seq) {
+	auto self = shared_from_this();
+	for (size_t i = 0; i < m_targets.size(); i++) {
+		Name name(m_targets.at(i).prefix);
+		name.append("ping");
+		if (m_options.payloadSize > 0) {
+			name.append("payload").appendNumber(m_options.payloadSize);
+		}
+		name.appendNumber(seq).appendTimestamp();
+		Interest interest(name);
+		interest.setInterestLifetime(PING_LIFETIME);
+		interest.setMustBeFresh(true);
+		interest.setCanBePrefix(false);
+		m_results.at(i).sent++;
+		m_outstanding++;
+		const auto sent = time::steady_clock::now();
+		m_face.expressInterest(
+		    interest,
+		    [self, i, sent](const Interest &interest, const Data &data) {
+			    self->m_results.at(i).rtts.push_back(
+			        static_cast<double>(
+			            time::duration_cast<time::microseconds>(
+			                time::steady_clock::now() - sent)
+			                .count()) /
+			        US_PER_MS);
+			    self->finishOne();
+		    },
+		    [self, i](const Interest &interest, const lp::Nack &nack) {
+			    self->m_results.at(i).nacks++;
+			    self->finishOne();
+		    },
+		    [self, i](const Interest &interest) {
+			    self->m_results.at(i).timeouts++;
+			    self->finishOne();
+		    });
+	}
+	if (seq + 1 < m_options.count) {
+		m_scheduler.schedule(time::milliseconds(m_options.intervalMs),
+		                     [self, seq] { self->sendRound(seq + 1); });
+	} else {
+		m_all_sent = true;
+	}
+}
+
+void Pinger::finishOne() {
+	m_outstanding--;
+	if (m_all_sent && m_outstanding == 0) {
+		m_done(toJson());
+	}
+}
+
+auto Pinger::toJson() const -> std::string {
+	stringstream json;
+	json << "[";
+	for (size_t i = 0; i < m_targets.size(); i++) {
+		const Result &result = m_results.at(i);
+		std::vector<double> rtts = result.rtts;
+		std::sort(rtts.begin(), rtts.end());
+		double sum = 0;
+		for (auto rtt : rtts) {
+			sum += rtt;
+		}
+		const auto received = static_cast<long>(rtts.size());
+		const double loss =
+		    result.sent == 0 ? 0.0
+		                     : static_cast<double>(result.sent - received) /
+		                           static_cast<double>(result.sent);
+		json << (i == 0 ? "" : ",") << endl
+		     << R"(    {"id":)" << m_targets.at(i).id << R"(,"prefix":")"
+		     << m_targets.at(i).prefix << R"(","sent":)" << result.sent
+		     << R"(,"received":)" << received << R"(,"nacks":)"
+		     << result.nacks << R"(,"timeouts":)" << result.timeouts
+		     << R"(,"loss":)" << loss
+		     << R"(,"min_ms":)" << (rtts.empty() ? 0.0 : rtts.front())
+		     << R"(,"avg_ms":)"
+		     << (rtts.empty() ? 0.0 : sum / static_cast<double>(received))
+		     << R"(,"p50_ms":)" << percentile(rtts, 0.5) << R"(,"p90_ms":)"
+		     << percentile(rtts, 0.9) << R"(,"p99_ms":)"
+		     << percentile(rtts, 0.99) << R"(,"max_ms":)"
+		     << (rtts.empty() ? 0.0 : rtts.back()) << "}";
+	}
+	json << endl << "]" << endl;
+	return json.str();
+}
+} // namespace ahnd
@@ -0,0 +1,52 @@
+#ifndef AHND_PINGER_H
+#define AHND_PINGER_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+#include "events.h"
+
+namespace ahnd {
+
+struct PingTarget {
+	long id;
+	ndn::Name prefix;
+};
+
+// Nearest rank percentile (p in 0-1) of sorted samples, 0 if there are none.
+auto percentile(const std::vector<double> &sorted, double p) -> double;
+
+// Measures RTT and loss to piers over their provisioned faces by sending
+// /<pier>/ping/payload/<size>/<seq> interests to all targets every interval.
+// Reports RTT percentiles and loss per pier as JSON once every reply is in
+// or has timed out.
+class Pinger : public std::enable_shared_from_this<Pinger> {
+  private:
+	struct Result {
+		std::vector<double> rtts;
+		long sent{0};
+		long nacks{0};
+		long timeouts{0};
+	};
+
+	ndn::Face &m_face;
+	ndn::Scheduler &m_scheduler;
+	std::vector<PingTarget> m_targets;
+	PingOptions m_options;
+	PingDoneCallback m_done;
+	std::vector<Result> m_results;
+	long m_outstanding{0};
+	bool m_all_sent{false};
+
+	void sendRound(long seq);
+	void finishOne();
+	auto toJson() const -> std::string;
+
+  public:
+	Pinger(ndn::Face &face, ndn::Scheduler &scheduler,
+	       std::vector<PingTarget> targets, PingOptions options,
+	       PingDoneCallback done);
+	void start();
+};
+} // namespace ahnd
+
+#endif // AHND_PINGER_H
@@ -0,0 +1,192 @@
+#include "retrypolicy.h"
+
+#include <algorithm>
+#include <deque>
+#include <iostream>
+#include <ndn-cxx/util/random.hpp>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+// Keep the shift in range, the cap is reached long before.
+constexpr int MAX_BACKOFF_SHIFT = 16;
+// A queued retry runs after this however full the budget still is, far
+// beyond any backoff so only a budget that is stuck gets here.
+constexpr auto QUEUED_MAX_WAIT = time::hours(24);
+
+struct RetryPolicy::Budget : std::enable_shared_from_this<Budget> {
+	// Null once the policy is gone, nothing is started after that.
+	Scheduler *scheduler;
+	size_t limit;
+	size_t pending{0};
+	std::deque<std::weak_ptr<Waiter>> queue;
+
+	Budget(Scheduler &scheduler, size_t limit)
+	    : scheduler(&scheduler), limit(limit) {}
+	// Start queued retries while there is room, dropping cancelled ones.
+	void release();
+};
+
+// One retry, shared by the events that may run it.  It counts against the
+// budget from when its delay starts until it runs or is cancelled (the
+// scheduler dropping the last event holding it).
+struct RetryPolicy::Waiter {
+	RetryOp op;
+	int attempt;
+	scheduler::EventCallback callback;
+	// Set while counted against the budget.
+	std::shared_ptr<Budget> budget;
+	// The delay of a queued retry once it starts, and the event its caller
+	// holds which is cancelled once it ran.
+	scheduler::ScopedEventId delay;
+	scheduler::EventId anchor;
+	bool done{false};
+
+	Waiter(RetryOp op, int attempt, scheduler::EventCallback callback)
+	    : op(op), attempt(attempt), callback(std::move(callback)) {}
+	~Waiter() { leave(); }
+	Waiter(const Waiter &) = delete;
+	auto operator=(const Waiter &) -> Waiter & = delete;
+	void leave() {
+		if (budget != nullptr) {
+			const auto left = std::move(budget);
+			budget = nullptr;
+			left->pending--;
+			left->release();
+		}
+	}
+};
+
+auto retryLimits(RetryOp op) -> RetryLimits {
+	switch (op) {
+	case RetryOp::PREFIX:
+		// Nothing works without them, never give up.
+		return {1000, 60000, 0};
+	case RetryOp::ARRIVAL:
+		// The heartbeat announces again anyway.
+		return {1000, 60000, 0};
+	case RetryOp::FACE:
+		return {1000, 30000, 6};
+	case RetryOp::ROUTE:
+		return {1000, 30000, 6};
+	case RetryOp::ND_INFO:
+		return {2000, 20000, 3};
+	}
+	return {1000, 60000, 0};
+}
+
+auto retryOpName(RetryOp op) -> const char * {
+	switch (op) {
+	case RetryOp::PREFIX:
+		return "prefix";
+	case RetryOp::ARRIVAL:
+		return "arrival";
+	case RetryOp::FACE:
+		return "face";
+	case RetryOp::ROUTE:
+		return "route";
+	case RetryOp::ND_INFO:
+		return "nd-info";
+	}
+	return "unknown";
+}
+
+static auto backoff(RetryOp op, int attempt) -> time::milliseconds {
+	const RetryLimits limits = retryLimits(op);
+	const int shift = std::min(std::max(attempt, 0), MAX_BACKOFF_SHIFT);
+	const long delay_ms = std::min(limits.baseMs << shift, limits.maxMs);
+	// Equal jitter, somewhere in the upper half of the backoff.
+	std::uniform_int_distribution<long> jitter(delay_ms / 2, delay_ms);
+	return time::milliseconds(jitter(random::getRandomNumberEngine()));
+}
+
+void RetryPolicy::Budget::release() {
+	while (scheduler != nullptr && pending < limit && !queue.empty()) {
+		const auto waiter = queue.front().lock();
+		queue.pop_front();
+		if (waiter != nullptr && !waiter->done) {
+			start(shared_from_this(), waiter);
+		}
+	}
+}
+
+RetryPolicy::RetryPolicy(Scheduler &scheduler, size_t budget)
+    : m_budget(make_shared<Budget>(scheduler, budget)) {}
+
+RetryPolicy::~RetryPolicy() { m_budget->scheduler = nullptr; }
+
+auto RetryPolicy::canRetry(RetryOp op, int attempt) -> bool {
+	const RetryLimits limits = retryLimits(op);
+	return limits.maxRetries == 0 || attempt < limits.maxRetries;
+}
+
+void RetryPolicy::start(const std::shared_ptr<Budget> &budget,
+                        const std::shared_ptr<Waiter> &waiter) {
+	waiter->budget = budget;
+	budget->pending++;
+	const auto wait = backoff(waiter->op, waiter->attempt);
+	cout << "AH Client: Retrying " << retryOpName(waiter->op) << " in "
+	     << wait.count() << "ms (attempt " << waiter->attempt + 1
+	     << ", was queued)" << endl;
+	const std::weak_ptr<Waiter> weak = waiter;
+	waiter->delay = budget->scheduler->schedule(wait, [weak] {
+		const auto locked = weak.lock();
+		if (locked != nullptr) {
+			run(*locked);
+		}
+	});
+}
+
+void RetryPolicy::run(Waiter &waiter) {
+	if (waiter.done) {
+		return;
+	}
+	waiter.done = true;
+	waiter.anchor.cancel();
+	waiter.callback();
+	waiter.leave();
+}
+
+auto RetryPolicy::schedule(RetryOp op, int attempt,
+                           const scheduler::EventCallback &callback)
+    -> scheduler::EventId {
+	Budget &budget = *m_budget;
+	budget.release();
+	auto waiter = make_shared<Waiter>(op, attempt, callback);
+	// Queued retries go first, in order.
+	if (budget.pending < budget.limit && budget.queue.empty()) {
+		waiter->budget = m_budget;
+		budget.pending++;
+		const auto wait = backoff(op, attempt);
+		cout << "AH Client: Retrying " << retryOpName(op) << " in "
+		     << wait.count() << "ms (attempt " << attempt + 1 << ")" << endl;
+		return budget.scheduler->schedule(wait,
+		                                  [waiter] { run(*waiter); });
+	}
+	budget.queue.push_back(waiter);
+	cout << "AH Client: Retry budget used up (" << budget.pending
+	     << " waiting), " << retryOpName(op) << " retry queued behind "
+	     << budget.queue.size() - 1 << " others" << endl;
+	waiter->anchor =
+	    budget.scheduler->schedule(QUEUED_MAX_WAIT, [waiter] { run(*waiter); });
+	return waiter->anchor;
+}
+
+auto RetryPolicy::pending() const -> size_t { return m_budget->pending; }
+
+auto RetryPolicy::queued() const -> size_t {
+	return static_cast<size_t>(
+	    std::count_if(m_budget->queue.begin(), m_budget->queue.end(),
+	                  [](const std::weak_ptr<Waiter> &queued) {
+		                  const auto waiter = queued.lock();
+		                  return waiter != nullptr && !waiter->done;
+	                  }));
+}
+
+void RetryPolicy::setBudget(size_t budget) {
+	m_budget->limit = budget;
+	m_budget->release();
+}
+} // namespace ahnd
@@ -0,0 +1,65 @@
+#ifndef AHND_RETRYPOLICY_H
+#define AHND_RETRYPOLICY_H
+
+#include <ndn-cxx/util/scheduler.hpp>
+
+namespace ahnd {
+
+// The operations that are retried, each with its own backoff and limit.
+enum class RetryOp {
+	PREFIX,  // Registering one of our own prefixes.
+	ARRIVAL, // Sending our multicast arrival.
+	FACE,    // faces/create for a pier.
+	ROUTE,   // rib/register for a pier's prefix.
+	ND_INFO  // Sending our nd-info to a pier.
+};
+
+struct RetryLimits {
+	long baseMs;
+	long maxMs;
+	// Retries before giving up, 0 never gives up.
+	int maxRetries;
+};
+
+// Shared backoff for everything that retries against NFD or a pier.  Delays
+// double per attempt up to a cap with jitter so nodes that failed together do
+// not retry together.  At most budget retries wait their delay at once, more
+// queue (in order, whatever the operation) until one of those runs or is
+// cancelled, so an overloaded NFD sees no more than budget retries per
+// backoff period from us however many operations failed.  A queued retry is
+// cancelled through its EventId like any other.
+class RetryPolicy {
+  private:
+	struct Budget;
+	struct Waiter;
+	std::shared_ptr<Budget> m_budget;
+
+	static void start(const std::shared_ptr<Budget> &budget,
+	                  const std::shared_ptr<Waiter> &waiter);
+	static void run(Waiter &waiter);
+
+  public:
+	RetryPolicy(ndn::Scheduler &scheduler, size_t budget);
+	~RetryPolicy();
+	RetryPolicy(const RetryPolicy &) = delete;
+	auto operator=(const RetryPolicy &) -> RetryPolicy & = delete;
+	// Whether an operation that has been retried attempt times may go again.
+	static auto canRetry(RetryOp op, int attempt) -> bool;
+	// Schedule retry number attempt + 1 of op.
+	auto schedule(RetryOp op, int attempt,
+	              const ndn::scheduler::EventCallback &callback)
+	    -> ndn::scheduler::EventId;
+	// Retries waiting their delay, never more than the budget.
+	auto pending() const -> size_t;
+	// Retries waiting for room in the budget.
+	auto queued() const -> size_t;
+	// A larger budget starts queued retries right away, a smaller one lets
+	// those already waiting run.
+	void setBudget(size_t budget);
+};
+
+auto retryLimits(RetryOp op) -> RetryLimits;
+auto retryOpName(RetryOp op) -> const char *;
+} // namespace ahnd
+
+#endif // AHND_RETRYPOLICY_H
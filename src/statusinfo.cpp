@@ -14,13 +14,12 @@ namespace ahnd {
 const uint64_t DISCOVERY_ROUTE_COST(0);
 const time::milliseconds DISCOVERY_ROUTE_EXPIRATION = 30_s;
 
-StatusInfo::StatusInfo(std::shared_ptr<nfd::Controller> controller)
-    : m_controller(std::move(controller)) {}
+StatusInfo::StatusInfo(std::shared_ptr<nfd::Controller> controller,
+                       WorkerPool &workers)
+    : m_controller(std::move(controller)), m_workers(workers) {}
 
 void StatusInfo::getStatus(const StatusCallback &callback,
                            const StatusErrorCallback &errorCallback) {
-	m_faces.clear();
-	m_ribs.clear();
 	nfd::FaceQueryFilter filter;
 	// filter.setFaceScope(ndn::nfd::FACE_SCOPE_NON_LOCAL);
 
@@ -34,6 +33,15 @@ void StatusInfo::getStatus(const StatusCallback &callback,
 	    });
 }
 
+void StatusInfo::getFaces(const FacesCallback &callback,
+                          const StatusErrorCallback &errorCallback) {
+	m_controller->fetch<nfd::FaceDataset>(
+	    [callback](auto &&dataset) { callback(dataset); },
+	    [errorCallback](uint32_t code, const std::string &reason) {
+		    errorCallback("Failed to query faces, reason: " + reason);
+	    });
+}
+
 void StatusInfo::faceResults(const StatusCallback &callback,
                              const StatusErrorCallback &errorCallback,
                              const std::vector<nfd::FaceStatus> &dataset) {
@@ -42,25 +50,27 @@ void StatusInfo::faceResults(const StatusCallback &callback,
 		return;
 	}
 
-	for (const auto &face_status : dataset) {
-		m_faces.push_back(face_status);
-	}
+	// Each request carries its own copy of the datasets along, requests may
+	// overlap and the JSON is built off this thread.
 	m_controller->fetch<nfd::RibDataset>(
-	    [this, callback](auto &&dataset) { ribResults(callback, dataset); },
+	    [this, callback, errorCallback, faces = dataset](auto &&ribs) {
+		    ribResults(callback, errorCallback, faces, ribs);
+	    },
 	    [errorCallback](uint32_t code, const std::string &reason) {
 		    errorCallback("Failed to query ribs, reason: " + reason);
 	    });
 }
 
-void StatusInfo::ribResults(const StatusCallback &callback,
-                            const std::vector<nfd::RibEntry> &dataset) {
+static auto statusJson(const std::vector<nfd::FaceStatus> &faces,
+                       const std::vector<nfd::RibEntry> &dataset) -> string {
+	std::unordered_map<long, std::vector<nfd::RibEntry>> ribs;
 	for (const auto &rib : dataset) {
 		for (const auto &route : rib.getRoutes()) {
-			const auto rib_list = m_ribs.find(route.getFaceId());
-			if (rib_list == m_ribs.end()) {
+			const auto rib_list = ribs.find(route.getFaceId());
+			if (rib_list == ribs.end()) {
 				std::vector<nfd::RibEntry> v;
 				v.push_back(rib);
-				m_ribs[route.getFaceId()] = v;
+				ribs[route.getFaceId()] = v;
 			} else {
 				rib_list->second.push_back(rib);
 			}
@@ -70,7 +80,7 @@ void StatusInfo::ribResults(const StatusCallback &callback,
 	stringstream statusstr;
 	statusstr << "[" << endl;
 	int fi = 0;
-	for (const auto &face_status : m_faces) {
+	for (const auto &face_status : faces) {
 		if (face_status.getFaceScope() !=
 		    nfd::FaceScope::FACE_SCOPE_NON_LOCAL) {
 			continue;
@@ -128,8 +138,8 @@ void StatusInfo::ribResults(const StatusCallback &callback,
 			          << face_status.getExpirationPeriod().count() << ","
 			          << endl;
 		}
-		const auto rib_list = m_ribs.find(face_status.getFaceId());
-		if (rib_list != m_ribs.end()) {
+		const auto rib_list = ribs.find(face_status.getFaceId());
+		if (rib_list != ribs.end()) {
 			statusstr << R"(    "routes":[)";
 			int ri = 0;
 			for (const auto &rib : rib_list->second) {
@@ -161,6 +171,23 @@ void StatusInfo::ribResults(const StatusCallback &callback,
 		statusstr << "  }";
 	}
 	statusstr << endl << "]"; // << endl;
-	callback(statusstr.str());
+	return statusstr.str();
+}
+
+void StatusInfo::ribResults(const StatusCallback &callback,
+                            const StatusErrorCallback &errorCallback,
+                            std::vector<nfd::FaceStatus> faces,
+                            std::vector<nfd::RibEntry> dataset) {
+	// A node with many faces and routes makes a big document, keep it off
+	// the I/O thread.
+	auto json = make_shared<string>();
+	m_workers.submit(
+	    [json, faces = std::move(faces), dataset = std::move(dataset)] {
+		    *json = statusJson(faces, dataset);
+	    },
+	    [callback, json] { callback(*json); },
+	    [errorCallback](const string &reason) {
+		    errorCallback("Failed to build status, reason: " + reason);
+	    });
 }
 } // namespace ahnd
@@ -7,27 +7,36 @@
 
 #include <ndn-cxx/mgmt/nfd/controller.hpp>
 
+#include "events.h"
+#include "workerpool.h"
+
 namespace ahnd {
 
-using StatusCallback = std::function<void(std::string json)>;
-using StatusErrorCallback = std::function<void(std::string reason)>;
+using FacesCallback =
+    std::function<void(const std::vector<ndn::nfd::FaceStatus> &faces)>;
 
 class StatusInfo {
   private:
 	std::shared_ptr<ndn::nfd::Controller> m_controller;
-	std::vector<ndn::nfd::FaceStatus> m_faces;
-	std::unordered_map<long, std::vector<ndn::nfd::RibEntry>> m_ribs;
+	WorkerPool &m_workers;
 
 	void faceResults(const StatusCallback &callback,
 	                 const StatusErrorCallback &errorCallback,
 	                 const std::vector<ndn::nfd::FaceStatus> &dataset);
 	void ribResults(const StatusCallback &callback,
-	                const std::vector<ndn::nfd::RibEntry> &dataset);
+	                const StatusErrorCallback &errorCallback,
+	                std::vector<ndn::nfd::FaceStatus> faces,
+	                std::vector<ndn::nfd::RibEntry> dataset);
 
   public:
-	explicit StatusInfo(std::shared_ptr<ndn::nfd::Controller> controller);
+	// The JSON is built on a worker, callback still runs on the I/O thread.
+	StatusInfo(std::shared_ptr<ndn::nfd::Controller> controller,
+	           WorkerPool &workers);
 	void getStatus(const StatusCallback &callback,
 	               const StatusErrorCallback &errorCallback);
+	// Just the face dataset (with counters), callback on the I/O thread.
+	void getFaces(const FacesCallback &callback,
+	              const StatusErrorCallback &errorCallback);
 };
 } // namespace ahnd
 
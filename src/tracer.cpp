@@ -0,0 +1,87 @@
+#include "tracer.h"
+
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+using namespace ndn;
+
+namespace ahnd {
+
+// All events are on one process, piers are its threads.
+constexpr int TRACE_PID = 1;
+
+Tracer::Tracer(size_t capacity)
+    : m_events(std::max<size_t>(capacity, 1)),
+      m_epoch(time::steady_clock::now()) {}
+
+void Tracer::record(const char *name, long track, TimePoint start,
+                    int64_t duration_us, long arg) {
+	if (!m_enabled) {
+		return;
+	}
+	Event &event = m_events.at(m_next);
+	strncpy(event.name.data(), name, event.name.size() - 1);
+	event.name.back() = '\0';
+	event.track = track;
+	event.startUs =
+	    time::duration_cast<time::microseconds>(start - m_epoch).count();
+	event.durationUs = duration_us;
+	event.arg = arg;
+	m_next = (m_next + 1) % m_events.size();
+	m_wrapped = m_wrapped || m_next == 0;
+}
+
+void Tracer::span(const char *name, long track, TimePoint start, long arg) {
+	record(name, track, start,
+	       time::duration_cast<time::microseconds>(time::steady_clock::now() -
+	                                               start)
+	           .count(),
+	       arg);
+}
+
+void Tracer::instant(const char *name, long track, long arg) {
+	record(name, track, time::steady_clock::now(), -1, arg);
+}
+
+void Tracer::nameTrack(long track, const std::string &name) {
+	while (m_track_names.size() >= m_events.size()) {
+		m_track_names.erase(m_track_names.begin());
+	}
+	m_track_names[track] = name;
+}
+
+void Tracer::clear() {
+	m_next = 0;
+	m_wrapped = false;
+}
+
+auto Tracer::json() const -> std::string {
+	stringstream out;
+	out << R"({"displayTimeUnit":"ms","traceEvents":[)";
+	out << R"({"name":"thread_name","ph":"M","pid":)" << TRACE_PID
+	    << R"(,"tid":0,"args":{"name":"node"}})";
+	for (const auto &track : m_track_names) {
+		out << R"(,{"name":"thread_name","ph":"M","pid":)" << TRACE_PID
+		    << R"(,"tid":)" << track.first << R"(,"args":{"name":")"
+		    << track.second << R"("}})";
+	}
+	// Oldest first.
+	const size_t count = m_wrapped ? m_events.size() : m_next;
+	const size_t first = m_wrapped ? m_next : 0;
+	for (size_t i = 0; i < count; i++) {
+		const Event &event = m_events.at((first + i) % m_events.size());
+		out << R"(,{"name":")" << event.name.data() << R"(","pid":)"
+		    << TRACE_PID << R"(,"tid":)" << event.track << R"(,"ts":)"
+		    << event.startUs;
+		if (event.durationUs < 0) {
+			out << R"(,"ph":"i","s":"t")";
+		} else {
+			out << R"(,"ph":"X","dur":)" << event.durationUs;
+		}
+		out << R"(,"args":{"n":)" << event.arg << "}}";
+	}
+	out << "]}";
+	return out.str();
+}
+} // namespace ahnd
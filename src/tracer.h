@@ -0,0 +1,57 @@
+#ifndef AHND_TRACER_H
+#define AHND_TRACER_H
+
+#include <ndn-cxx/mgmt/nfd/controller.hpp>
+
+namespace ahnd {
+
+constexpr size_t TRACE_CAPACITY = 8192;
+constexpr size_t TRACE_NAME_SIZE = 24;
+
+// Spans of the provisioning chain (announcement handling, face creation,
+// route registration, nd-info round trips and retry waits) kept in a fixed
+// ring, the oldest are overwritten.  Recording copies a few words and never
+// allocates, dumping produces Chrome trace JSON (chrome://tracing or
+// ui.perfetto.dev) with a track per pier.  Only used from the I/O thread.
+class Tracer {
+  public:
+	using TimePoint = ndn::time::steady_clock::time_point;
+
+  private:
+	struct Event {
+		std::array<char, TRACE_NAME_SIZE> name;
+		// The pier's DBEntry::track, 0 for the node itself.
+		long track;
+		int64_t startUs;
+		// Negative for an instant event.
+		int64_t durationUs;
+		long arg;
+	};
+
+	std::vector<Event> m_events;
+	size_t m_next{0};
+	bool m_wrapped{false};
+	bool m_enabled{true};
+	TimePoint m_epoch;
+	std::map<long, std::string> m_track_names;
+
+	void record(const char *name, long track, TimePoint start,
+	            int64_t duration_us, long arg);
+
+  public:
+	explicit Tracer(size_t capacity = TRACE_CAPACITY);
+	// A span from start until now, arg is shown with it (the attempt for
+	// commands).
+	void span(const char *name, long track, TimePoint start, long arg = 0);
+	void instant(const char *name, long track, long arg = 0);
+	// Label a track, a pier's prefix.  Tracks are never reused, the names
+	// of the oldest are dropped once there are more than events.
+	void nameTrack(long track, const std::string &name);
+	void setEnabled(bool enabled) { m_enabled = enabled; }
+	auto enabled() const -> bool { return m_enabled; }
+	void clear();
+	auto json() const -> std::string;
+};
+} // namespace ahnd
+
+#endif // AHND_TRACER_H
@@ -0,0 +1,40 @@
+#include "virtualclock.h"
+
+#include <ndn-cxx/util/random.hpp>
+
+using namespace ndn;
+
+namespace ahnd {
+
+VirtualClock::VirtualClock(boost::asio::io_service &io, const uint32_t seed)
+    : m_io(io), m_steady(std::make_shared<time::UnitTestSteadyClock>()),
+      m_system(std::make_shared<time::UnitTestSystemClock>()) {
+	time::setCustomClocks(m_steady, m_system);
+	random::getRandomNumberEngine().seed(seed);
+}
+
+VirtualClock::~VirtualClock() { time::setCustomClocks(nullptr, nullptr); }
+
+void VirtualClock::poll() {
+	// A poll that ran out of work leaves the io_service stopped.
+	if (m_io.stopped()) {
+		m_io.reset();
+	}
+	m_io.poll();
+}
+
+void VirtualClock::advance(time::nanoseconds duration,
+                           const time::nanoseconds tick) {
+	// Whatever is already due runs at the current time.
+	poll();
+	while (duration > time::nanoseconds::zero()) {
+		const time::nanoseconds step =
+		    tick > time::nanoseconds::zero() ? std::min(tick, duration)
+		                                     : duration;
+		m_steady->advance(step);
+		m_system->advance(step);
+		duration -= step;
+		poll();
+	}
+}
+} // namespace ahnd
@@ -0,0 +1,38 @@
+#ifndef AHND_VIRTUALCLOCK_H
+#define AHND_VIRTUALCLOCK_H
+
+#include <boost/asio/io_service.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+namespace ahnd {
+
+// Simulated time for driving clients much faster than real time, hours of
+// keepalive rounds, retries and failure detection in a few milliseconds.
+// While one exists every ndn-cxx clock reads it instead of the system's, so
+// the schedulers, name timestamps and RTT measurements of everything on the
+// io_service follow it.  Work handed to a WorkerPool still takes real time,
+// its completion runs on whichever step it is ready by.
+class VirtualClock {
+  private:
+	boost::asio::io_service &m_io;
+	std::shared_ptr<ndn::time::UnitTestSteadyClock> m_steady;
+	std::shared_ptr<ndn::time::UnitTestSystemClock> m_system;
+
+	void poll();
+
+  public:
+	// Also seeds the random engine so backoff jitter and reply delays repeat
+	// from run to run.
+	explicit VirtualClock(boost::asio::io_service &io, uint32_t seed = 0);
+	// Puts the real clocks back.
+	~VirtualClock();
+	VirtualClock(const VirtualClock &) = delete;
+	auto operator=(const VirtualClock &) -> VirtualClock & = delete;
+	// Move time forward in steps of tick, running whatever became due after
+	// each step.
+	void advance(ndn::time::nanoseconds duration,
+	             ndn::time::nanoseconds tick = ndn::time::milliseconds(1));
+};
+} // namespace ahnd
+
+#endif // AHND_VIRTUALCLOCK_H
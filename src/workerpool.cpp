@@ -0,0 +1,102 @@
+#include "workerpool.h"
+
+#include <iostream>
+
+using namespace std;
+
+namespace ahnd {
+
+// Times a worker looks for more work before going to sleep.
+constexpr int WORKER_SPINS = 64;
+
+static auto workerCount(size_t threads) -> size_t {
+	if (threads > 0) {
+		return threads;
+	}
+	// Leave a core for the I/O thread.
+	const size_t cores = thread::hardware_concurrency();
+	return std::min(MAX_WORKERS, cores > 1 ? cores - 1 : 1);
+}
+
+WorkerPool::WorkerPool(boost::asio::io_service &io, size_t threads)
+    : m_io(io), m_queue(WORKER_QUEUE_SIZE) {
+	const size_t count = workerCount(threads);
+	for (size_t i = 0; i < count; i++) {
+		m_threads.emplace_back([this] { run(); });
+	}
+	cout << "AH Client: Started " << count << " worker threads" << endl;
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_wake.notify_all();
+	for (auto &worker : m_threads) {
+		worker.join();
+	}
+}
+
+void WorkerPool::submit(Work work, Work done, Failed failed) {
+	HandoffQueue::Task task = [this, work = std::move(work),
+	                           done = std::move(done),
+	                           failed = std::move(failed)]() mutable {
+		string reason;
+		try {
+			work();
+			m_io.post(std::move(done));
+			return;
+		} catch (const std::exception &e) {
+			reason = e.what();
+		} catch (...) {
+			reason = "unknown exception";
+		}
+		cout << "AH Client: ERROR in worker task: " << reason << endl;
+		if (failed) {
+			m_io.post([failed = std::move(failed), reason] { failed(reason); });
+		}
+	};
+	if (!m_queue.push(task)) {
+		// Backed up, doing it here is no worse than waiting for a worker.
+		task();
+		return;
+	}
+	// A worker going idle bumps m_idle before its last look at the queue so
+	// either it finds the task or we see it and wake it.
+	atomic_thread_fence(memory_order_seq_cst);
+	if (m_idle.load() > 0) {
+		lock_guard<mutex> lock(m_mutex);
+		m_wake.notify_one();
+	}
+}
+
+void WorkerPool::run() {
+	HandoffQueue::Task task;
+	int spins = 0;
+	while (!m_stop) {
+		if (m_queue.pop(task)) {
+			task();
+			task = nullptr;
+			spins = 0;
+			continue;
+		}
+		if (++spins < WORKER_SPINS) {
+			this_thread::yield();
+			continue;
+		}
+		spins = 0;
+		unique_lock<mutex> lock(m_mutex);
+		m_idle++;
+		if (!m_queue.pop(task) && !m_stop) {
+			m_wake.wait(lock);
+		}
+		m_idle--;
+		lock.unlock();
+		if (task) {
+			task();
+			task = nullptr;
+		}
+	}
+}
+} // namespace ahnd
@@ -0,0 +1,54 @@
+#ifndef AHND_WORKERPOOL_H
+#define AHND_WORKERPOOL_H
+
+#include <boost/asio/io_service.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "handoffqueue.h"
+
+namespace ahnd {
+
+constexpr size_t WORKER_QUEUE_SIZE = 1024;
+constexpr size_t MAX_WORKERS = 4;
+
+// A few threads for CPU heavy work (signing, encoding, JSON) so it does not
+// hold up the thread running the Face.  Work is handed over through a
+// lock-free queue and its completion is posted back to the io_service, so
+// completions run on the I/O thread and may use the Face and client state.
+// Work itself must only touch what it was given.
+class WorkerPool {
+  public:
+	using Work = std::function<void()>;
+	using Failed = std::function<void(const std::string &reason)>;
+
+  private:
+	boost::asio::io_service &m_io;
+	HandoffQueue m_queue;
+	std::vector<std::thread> m_threads;
+	std::atomic<bool> m_stop{false};
+	// Idle workers sleep on the condition variable, the mutex only guards
+	// the wakeup and is never taken by a worker that has work.
+	std::atomic<size_t> m_idle{0};
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+
+	void run();
+
+  public:
+	// Zero threads picks one per spare core (up to MAX_WORKERS).
+	explicit WorkerPool(boost::asio::io_service &io, size_t threads = 0);
+	~WorkerPool();
+	WorkerPool(const WorkerPool &) = delete;
+	auto operator=(const WorkerPool &) -> WorkerPool & = delete;
+	// Run work on a worker, then done on the I/O thread.  When the queue is
+	// full work runs right away on the caller's (the I/O) thread instead.  If
+	// work throws failed runs on the I/O thread instead of done, so whoever
+	// waits for the result still gets an answer.
+	void submit(Work work, Work done, Failed failed = nullptr);
+};
+} // namespace ahnd
+
+#endif // AHND_WORKERPOOL_H
@@ -0,0 +1,83 @@
+#include "clientfixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(AdmissionCaps)
+
+BOOST_AUTO_TEST_CASE(DeferredPierJoinsWhenSlotFrees) {
+	Timing timing;
+	timing.maxPendingPiers = 1;
+	ClientFixture fixture(timing);
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name first("/test/first");
+	const Name second("/test/second");
+	fixture.announce(first, 1);
+	fixture.announce(second, 2);
+	BOOST_CHECK(fixture.hasPier(first));
+	BOOST_CHECK(!fixture.hasPier(second));
+
+	// faces/create and rib/register of the first, once it is up the second
+	// is handled without announcing again.
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_REQUIRE(fixture.state(first) == PierState::CONFIRMED);
+	BOOST_CHECK(fixture.hasPier(second));
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_CHECK(fixture.state(second) == PierState::CONFIRMED);
+}
+
+BOOST_AUTO_TEST_CASE(DepartedPierIsNotReadmitted) {
+	Timing timing;
+	timing.maxPendingPiers = 1;
+	ClientFixture fixture(timing);
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name first("/test/first");
+	const Name second("/test/second");
+	fixture.announce(first, 1);
+	fixture.announce(second, 2);
+	fixture.depart(second, 2);
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_REQUIRE(fixture.state(first) == PierState::CONFIRMED);
+	BOOST_CHECK(!fixture.hasPier(second));
+}
+
+BOOST_AUTO_TEST_CASE(PiersPerSource) {
+	Timing timing;
+	timing.maxPiersPerSource = 2;
+	ClientFixture fixture(timing);
+	BOOST_REQUIRE(fixture.canAnnounce());
+	fixture.provision("/test/a", 1);
+	fixture.provision("/test/b", 1);
+	fixture.provision("/test/c", 1);
+	fixture.provision("/test/d", 2);
+	BOOST_CHECK(fixture.hasPier("/test/a"));
+	BOOST_CHECK(fixture.hasPier("/test/b"));
+	BOOST_CHECK(!fixture.hasPier("/test/c"));
+	BOOST_CHECK(fixture.hasPier("/test/d"));
+}
+
+BOOST_AUTO_TEST_CASE(TotalPiers) {
+	Timing timing;
+	timing.maxPiers = 2;
+	ClientFixture fixture(timing);
+	BOOST_REQUIRE(fixture.canAnnounce());
+	fixture.provision("/test/a", 1);
+	fixture.provision("/test/b", 2);
+	fixture.provision("/test/c", 3);
+	BOOST_CHECK(!fixture.hasPier("/test/c"));
+	// A known pier is still heard.
+	fixture.announce("/test/a", 1);
+	BOOST_CHECK(fixture.state("/test/a") == PierState::CONFIRMED);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ahnd
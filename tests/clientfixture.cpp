@@ -0,0 +1,352 @@
+#include "clientfixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+constexpr uint16_t PIER_PORT = 6363;
+constexpr int BYTE_BITS = 8;
+// Room left in a gossip reply for the Data around the list.
+constexpr size_t GOSSIP_DATA_OVERHEAD = 128;
+// Real time allowed for the client's workers to build a reply.
+constexpr int WORKER_WAIT_MS = 5000;
+
+static auto gossipBudget(const Name &name) -> size_t {
+	return MAX_NDN_PACKET_SIZE - name.wireEncode().size() -
+	       GOSSIP_DATA_OVERHEAD;
+}
+
+// Keep the client's KeyChain away from the user's keys, with no identity it
+// signs its commands with a digest.
+static void useMemoryKeyChain() {
+	setenv("NDN_CLIENT_PIB", "pib-memory:", 1);
+	setenv("NDN_CLIENT_TPM", "tpm-memory:", 1);
+}
+
+ClientFixture::ClientFixture(const Timing &timing)
+    : m_clock(m_io), m_keyChain("pib-memory:", "tpm-memory:"),
+      m_face(m_io, m_keyChain, util::DummyClientFace::Options{true, true}) {
+	useMemoryKeyChain();
+	m_client = std::make_unique<AHClient>(m_face, Name("/test/client"),
+	                                      Name("/ahnd"), PIER_PORT, timing);
+	PierEvents events;
+	events.pierUp = [this](const DBEntry &pier) { up.push_back(pier.prefix); };
+	events.pierDown = [this](const DBEntry &pier) {
+		down.push_back(pier.prefix);
+	};
+	m_client->setPierEvents(std::move(events));
+	m_client->registerPrefixes();
+	advance(time::milliseconds(100));
+}
+
+ClientFixture::~ClientFixture() {
+	m_client->shutdown();
+	advance(time::milliseconds(10));
+	m_client.reset();
+}
+
+auto ClientFixture::canAnnounce() -> bool {
+	return m_client->getIp().s_addr != 0 || m_client->hasIp6();
+}
+
+void ClientFixture::advance(const time::nanoseconds duration) {
+	// Fine enough for the second scale timers of the tests.
+	m_clock.advance(duration, time::milliseconds(10));
+}
+
+auto ClientFixture::pierAddress(const uint16_t host) -> Name::Component {
+	const auto high = static_cast<uint8_t>(host >> BYTE_BITS);
+	const auto low = static_cast<uint8_t>(host);
+	if (m_client->getIp().s_addr != 0) {
+		// 198.18.<high>.<low>, the benchmarking range has room for a big
+		// segment.
+		const std::array<uint8_t, sizeof(in_addr)> ip{198, 18, high, low};
+		return Name::Component(ip.data(), ip.size());
+	}
+	// 2001:db8::<high><low>
+	std::array<uint8_t, sizeof(in6_addr)> ip6{0x20, 0x01, 0x0d, 0xb8};
+	ip6.at(ip6.size() - 2) = high;
+	ip6.back() = low;
+	return Name::Component(ip6.data(), ip6.size());
+}
+
+auto ClientFixture::announcementName(const Name &root, const char *kind,
+                                     const Name &prefix,
+                                     const Name::Component &address) -> Name {
+	Name name(root);
+	name.append(kind).append(address);
+	const uint16_t port = PIER_PORT;
+	// NOLINTNEXTLINE: unsafe C style cast
+	name.append(reinterpret_cast<const uint8_t *>(&port), sizeof(port));
+	name.appendNumber(prefix.size()).append(prefix).appendTimestamp();
+	return name;
+}
+
+void ClientFixture::announce(const Name &prefix, const uint16_t host,
+                             const std::vector<Name> &extras) {
+	Interest interest(announcementName(m_client->getPrefix(), "nd-info",
+	                                   prefix, pierAddress(host)));
+	interest.setCanBePrefix(false);
+	if (!extras.empty()) {
+		auto params = makeEmptyBlock(tlv::ApplicationParameters);
+		for (const auto &extra : extras) {
+			params.push_back(extra.wireEncode());
+		}
+		params.encode();
+		interest.setApplicationParameters(params);
+	}
+	m_face.receive(interest);
+	advance(time::milliseconds(1));
+}
+
+void ClientFixture::announceFrom(const Name &prefix, const in_addr &ip) {
+	// NOLINTNEXTLINE: unsafe C style cast
+	const Name::Component address(reinterpret_cast<const uint8_t *>(&ip),
+	                              sizeof(ip));
+	Interest interest(announcementName(m_client->getPrefix(), "nd-info",
+	                                   prefix, address));
+	interest.setCanBePrefix(false);
+	m_face.receive(interest);
+	advance(time::milliseconds(1));
+}
+
+void ClientFixture::arrive(const Name &prefix, const uint16_t host) {
+	Interest interest(
+	    announcementName("/ahnd", "arrival", prefix, pierAddress(host)));
+	interest.setCanBePrefix(true);
+	m_face.receive(interest);
+	advance(time::milliseconds(1));
+}
+
+void ClientFixture::depart(const Name &prefix, const uint16_t host) {
+	Interest interest(
+	    announcementName("/ahnd", "departure", prefix, pierAddress(host)));
+	interest.setCanBePrefix(true);
+	m_face.receive(interest);
+	advance(time::milliseconds(1));
+}
+
+void ClientFixture::keepAliveFrom(const Name &prefix) {
+	Name name(m_client->getPrefix());
+	name.append("nd-keepalive").appendTimestamp();
+	Interest interest(name);
+	interest.setCanBePrefix(false);
+	interest.setTag(std::make_shared<lp::IncomingFaceIdTag>(
+	    static_cast<uint64_t>(pier(prefix).faceId)));
+	m_face.receive(interest);
+	advance(time::milliseconds(1));
+}
+
+void ClientFixture::answerCommands() {
+	const Name nfd("/localhost/nfd");
+	// Answering may send more commands, those wait for the next call.
+	const std::vector<Interest> pending(
+	    m_face.sentInterests.begin() + static_cast<long>(m_answered),
+	    m_face.sentInterests.end());
+	m_answered = m_face.sentInterests.size();
+	for (const auto &interest : pending) {
+		const Name &name = interest.getName();
+		if (!nfd.isPrefixOf(name) || name.size() <= nfd.size() + 2 ||
+		    name.at(nfd.size() + 1).toUri() == "list") {
+			continue;
+		}
+		nfd::ControlParameters parameters(
+		    name.at(nfd.size() + 2).blockFromValue());
+		if (name.at(nfd.size() + 1).toUri() == "create") {
+			parameters.setFaceId(static_cast<uint64_t>(m_next_face_id++));
+		}
+		if (name.at(nfd.size()).toUri() == "rib") {
+			if (!parameters.hasOrigin()) {
+				parameters.setOrigin(nfd::ROUTE_ORIGIN_APP);
+			}
+			if (!parameters.hasCost()) {
+				parameters.setCost(0);
+			}
+			if (!parameters.hasFlags()) {
+				parameters.setFlags(nfd::ROUTE_FLAG_CHILD_INHERIT);
+			}
+		}
+		nfd::ControlResponse response(200, "OK");
+		response.setBody(parameters.wireEncode());
+		auto data = std::make_shared<Data>(name);
+		data->setContent(response.wireEncode());
+		m_keyChain.sign(*data, security::signingWithSha256());
+		m_face.receive(*data);
+	}
+	advance(time::milliseconds(1));
+}
+
+void ClientFixture::provision(const Name &prefix, const uint16_t host) {
+	announce(prefix, host);
+	// faces/create, then rib/register.
+	answerCommands();
+	answerCommands();
+}
+
+void ClientFixture::answerKeepAlives() {
+	const std::vector<Interest> pending(
+	    m_face.sentInterests.begin() + static_cast<long>(m_keepalives),
+	    m_face.sentInterests.end());
+	m_keepalives = m_face.sentInterests.size();
+	for (const auto &interest : pending) {
+		const Name &name = interest.getName();
+		if (name.size() < 2 || name.at(-2).toUri() != "nd-keepalive") {
+			continue;
+		}
+		auto data = std::make_shared<Data>(name);
+		data->setFreshnessPeriod(time::seconds(1));
+		m_keyChain.sign(*data, security::signingWithSha256());
+		m_face.receive(*data);
+	}
+	advance(time::milliseconds(1));
+}
+
+void ClientFixture::answerFaceDataset() {
+	const Name list("/localhost/nfd/faces/list");
+	const std::vector<Interest> pending(
+	    m_face.sentInterests.begin() + static_cast<long>(m_datasets),
+	    m_face.sentInterests.end());
+	m_datasets = m_face.sentInterests.size();
+	for (const auto &interest : pending) {
+		if (!list.isPrefixOf(interest.getName())) {
+			continue;
+		}
+		Buffer content;
+		m_client->visitPiers([&](const DBEntry &pier) {
+			const Block &status = nfd::FaceStatus()
+			                          .setFaceId(pier.faceId)
+			                          .setRemoteUri("udp4://198.18.0.1:6363")
+			                          .setLocalUri("udp4://198.18.0.2:6363")
+			                          .wireEncode();
+			content.insert(content.end(), status.begin(), status.end());
+		});
+		Name name(interest.getName());
+		name.appendVersion().appendSegment(0);
+		auto data = std::make_shared<Data>(name);
+		data->setFinalBlock(name.at(-1));
+		data->setContent(content.data(), content.size());
+		m_keyChain.sign(*data, security::signingWithSha256());
+		m_face.receive(*data);
+	}
+	advance(time::milliseconds(1));
+}
+
+auto ClientFixture::answerGossip(const Name &pier,
+                                 const std::vector<PierListEntry> &entries,
+                                 const uint64_t version) -> size_t {
+	const std::vector<Interest> pending(
+	    m_face.sentInterests.begin() + static_cast<long>(m_gossips),
+	    m_face.sentInterests.end());
+	m_gossips = m_face.sentInterests.size();
+	size_t answered = 0;
+	for (const auto &interest : pending) {
+		const Name &name = interest.getName();
+		if (!pier.isPrefixOf(name)) {
+			continue;
+		}
+		size_t i = 0;
+		while (i < name.size() && name.at(i).toUri() != "nd-gossip") {
+			i++;
+		}
+		if (i + 2 >= name.size()) {
+			continue;
+		}
+		// <known version>/<offset>, a stale version starts over.
+		const uint64_t offset =
+		    name.at(i + 1).toNumber() == version ? name.at(i + 2).toNumber()
+		                                         : 0;
+		const Block list =
+		    PierList::page(version, entries, offset, gossipBudget(name))
+		        .wireEncode();
+		auto data = std::make_shared<Data>(name);
+		data->setFreshnessPeriod(time::seconds(1));
+		data->setContent(list);
+		m_keyChain.sign(*data, security::signingWithSha256());
+		m_face.receive(*data);
+		answered++;
+	}
+	advance(time::milliseconds(1));
+	return answered;
+}
+
+auto ClientFixture::pullGossip(const Name &pier) -> std::vector<PierListEntry> {
+	std::vector<PierListEntry> entries;
+	uint64_t version = 0;
+	uint64_t offset = 0;
+	do {
+		Name name(m_client->getPrefix());
+		name.append("nd-gossip")
+		    .appendNumber(version)
+		    .appendNumber(offset)
+		    .appendNumber(pier.size())
+		    .append(pier)
+		    .appendTimestamp();
+		Interest interest(name);
+		interest.setCanBePrefix(false);
+		interest.setMustBeFresh(true);
+		const size_t before = m_face.sentData.size();
+		m_face.receive(interest);
+		for (int ms = 0;
+		     ms < WORKER_WAIT_MS && m_face.sentData.size() == before; ms++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			advance(time::milliseconds(1));
+		}
+		BOOST_REQUIRE_GT(m_face.sentData.size(), before);
+		const Data &data = m_face.sentData.back();
+		BOOST_CHECK_LE(data.wireEncode().size(), MAX_NDN_PACKET_SIZE);
+		const PierList list(data.getContent().blockFromValue());
+		BOOST_REQUIRE_EQUAL(list.offset(), offset);
+		version = list.version();
+		entries.insert(entries.end(), list.entries().begin(),
+		               list.entries().end());
+		offset = list.next();
+	} while (offset != 0);
+	return entries;
+}
+
+auto ClientFixture::sent(const std::string &component) -> size_t {
+	size_t count = 0;
+	for (const auto &interest : m_face.sentInterests) {
+		for (const auto &name_component : interest.getName()) {
+			if (name_component.toUri() == component) {
+				count++;
+				break;
+			}
+		}
+	}
+	return count;
+}
+
+auto ClientFixture::hasPier(const Name &prefix) -> bool {
+	bool found = false;
+	m_client->visitPiers([&](const DBEntry &pier) {
+		found = found || pier.prefix.equals(prefix);
+	});
+	return found;
+}
+
+auto ClientFixture::pier(const Name &prefix) -> DBEntry {
+	std::vector<DBEntry> found;
+	m_client->visitPiers([&](const DBEntry &pier) {
+		if (pier.prefix.equals(prefix)) {
+			found.push_back(pier);
+		}
+	});
+	BOOST_REQUIRE_EQUAL(found.size(), 1U);
+	return found.front();
+}
+
+auto ClientFixture::state(const Name &prefix) -> PierState {
+	return pier(prefix).state;
+}
+
+} // namespace tests
+} // namespace ahnd
@@ -0,0 +1,92 @@
+#ifndef AHND_CLIENTFIXTURE_H
+#define AHND_CLIENTFIXTURE_H
+
+#include "ahclient.h"
+#include "pierlist.h"
+#include "virtualclock.h"
+
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+namespace ahnd {
+namespace tests {
+
+// A client on a DummyClientFace under a VirtualClock.  NFD is played by
+// answerCommands(), piers by announce() and answerKeepAlives(), everything
+// else the client sends goes unanswered and times out on the virtual clock.
+class ClientFixture {
+  private:
+	boost::asio::io_service m_io;
+	VirtualClock m_clock;
+	ndn::KeyChain m_keyChain;
+	ndn::util::DummyClientFace m_face;
+	std::unique_ptr<AHClient> m_client;
+	// Sent interests already looked at by answerCommands().
+	size_t m_answered{0};
+	size_t m_keepalives{0};
+	size_t m_datasets{0};
+	size_t m_gossips{0};
+	int m_next_face_id{300};
+
+	// A test address in the family the client has.
+	auto pierAddress(uint16_t host) -> ndn::Name::Component;
+	// <root>/<kind>/<ip>/<port>/<prefix length>/<prefix>/<timestamp>
+	auto announcementName(const ndn::Name &root, const char *kind,
+	                      const ndn::Name &prefix,
+	                      const ndn::Name::Component &address) -> ndn::Name;
+
+  public:
+	explicit ClientFixture(const Timing &timing = Timing());
+	~ClientFixture();
+	ClientFixture(const ClientFixture &) = delete;
+	auto operator=(const ClientFixture &) -> ClientFixture & = delete;
+
+	// Prefixes passed to the client's pierUp and pierDown events.
+	std::vector<ndn::Name> up;
+	std::vector<ndn::Name> down;
+
+	auto client() -> AHClient & { return *m_client; }
+	auto face() -> ndn::util::DummyClientFace & { return m_face; }
+	// Without any address the client refuses every pier.
+	auto canAnnounce() -> bool;
+	void advance(ndn::time::nanoseconds duration);
+	// Deliver the nd-info of a pier, each host number is its own address.
+	void announce(const ndn::Name &prefix, uint16_t host,
+	              const std::vector<ndn::Name> &extras = {});
+	// Deliver the nd-info of a pier at an IPv4 address of our choosing.
+	void announceFrom(const ndn::Name &prefix, const in_addr &ip);
+	// Deliver a pier's multicast arrival, the heartbeat sent with every
+	// keepalive round.
+	void arrive(const ndn::Name &prefix, uint16_t host);
+	// Deliver a pier's multicast departure.
+	void depart(const ndn::Name &prefix, uint16_t host);
+	// Deliver a keepalive from a pier over its face.
+	void keepAliveFrom(const ndn::Name &prefix);
+	// Answer the NFD commands sent since the last call, all succeed.
+	void answerCommands();
+	// Announce a pier and answer its faces/create and rib/register.
+	void provision(const ndn::Name &prefix, uint16_t host);
+	// Answer the keepalives sent since the last call.
+	void answerKeepAlives();
+	// Answer face dataset requests with the piers' faces, their counters
+	// never move.
+	void answerFaceDataset();
+	// Answer the gossip requests to pier sent since the last call with pages
+	// of its list, returns how many were answered.  Requests to other piers
+	// go unanswered.
+	auto answerGossip(const ndn::Name &pier,
+	                  const std::vector<PierListEntry> &entries,
+	                  uint64_t version = 1) -> size_t;
+	// Pull the client's whole list as pier would, page by page.  The pages
+	// are built on the client's workers, in real time.
+	auto pullGossip(const ndn::Name &pier) -> std::vector<PierListEntry>;
+	// Interests sent so far whose name contains the component.
+	auto sent(const std::string &component) -> size_t;
+	auto hasPier(const ndn::Name &prefix) -> bool;
+	auto state(const ndn::Name &prefix) -> PierState;
+	auto pier(const ndn::Name &prefix) -> DBEntry;
+};
+
+} // namespace tests
+} // namespace ahnd
+
+#endif // AHND_CLIENTFIXTURE_H
@@ -0,0 +1,139 @@
+#include "bloomfilter.h"
+#include "clientfixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+// Piers ranked above (that win an election against the client) or below
+// it, in rank order.
+static auto rankedPiers(const Name &self, const size_t count,
+                        const bool above) -> std::vector<Name> {
+	std::vector<std::pair<uint64_t, Name>> ranked;
+	for (int i = 0; ranked.size() < count; i++) {
+		const Name name("/test/pier" + std::to_string(i));
+		if ((prefixHash(name) < prefixHash(self)) == above) {
+			ranked.emplace_back(prefixHash(name), name);
+		}
+	}
+	std::sort(ranked.begin(), ranked.end());
+	std::vector<Name> names;
+	for (const auto &rank : ranked) {
+		names.push_back(rank.second);
+	}
+	return names;
+}
+
+static auto outranking(const Name &self, const size_t count)
+    -> std::vector<Name> {
+	return rankedPiers(self, count, true);
+}
+
+BOOST_AUTO_TEST_SUITE(Delegates)
+
+BOOST_AUTO_TEST_CASE(ReelectedDelegateKeepsExtraPrefixes) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	fixture.client().setDelegates(1);
+	const auto piers = outranking(fixture.client().getPrefix(), 2);
+	const Name &first = piers.at(0);
+	const Name &second = piers.at(1);
+	const std::vector<Name> extras{"/test/extra"};
+
+	fixture.announce(second, 2, extras);
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_REQUIRE(fixture.state(second) == PierState::CONFIRMED);
+	BOOST_CHECK(fixture.pier(second).extraPrefixes == extras);
+
+	// Outranked, the second is dropped for the first.
+	fixture.provision(first, 1);
+	BOOST_REQUIRE(fixture.hasPier(first));
+	BOOST_CHECK(!fixture.hasPier(second));
+
+	// Once the first leaves the second is set up again from the election's
+	// record of its announcement, extra prefixes and all.
+	fixture.depart(first, 1);
+	BOOST_CHECK(!fixture.hasPier(first));
+	BOOST_REQUIRE(fixture.hasPier(second));
+	BOOST_CHECK(fixture.pier(second).extraPrefixes == extras);
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_CHECK(fixture.state(second) == PierState::CONFIRMED);
+}
+
+BOOST_AUTO_TEST_CASE(NonDelegateNdInfoIsAcked) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	fixture.client().setDelegates(1);
+	const auto piers = outranking(fixture.client().getPrefix(), 2);
+	const Name &delegate = piers.at(0);
+	const Name &member = piers.at(1);
+	fixture.provision(delegate, 1);
+	BOOST_REQUIRE(fixture.state(delegate) == PierState::CONFIRMED);
+
+	// The member may still think we are a delegate, its nd-info must not go
+	// unanswered even though it gets no face from us.
+	const size_t before = fixture.face().sentData.size();
+	fixture.announce(member, 2);
+	BOOST_CHECK(!fixture.hasPier(member));
+	BOOST_REQUIRE_EQUAL(fixture.face().sentData.size(), before + 1);
+	const Name &acked = fixture.face().sentData.back().getName();
+	BOOST_CHECK(std::find(acked.begin(), acked.end(),
+	                      Name::Component("nd-info")) != acked.end());
+}
+
+// Past what one gossip page carries.
+constexpr size_t LARGE_SEGMENT = 300;
+
+BOOST_AUTO_TEST_CASE(DelegateRelaysLargeSegment) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	fixture.client().setDelegates(1);
+	// Everyone else ranks below us, we are the delegate and keep them all.
+	const auto members =
+	    rankedPiers(fixture.client().getPrefix(), LARGE_SEGMENT, false);
+	for (size_t i = 0; i < members.size(); i++) {
+		fixture.provision(members.at(i), static_cast<uint16_t>(i + 1));
+	}
+	BOOST_REQUIRE(fixture.state(members.back()) == PierState::CONFIRMED);
+
+	// An ordinary member pulls the whole segment from us.
+	const auto pulled = fixture.pullGossip(members.front());
+	BOOST_CHECK_EQUAL(pulled.size(), LARGE_SEGMENT);
+}
+
+BOOST_AUTO_TEST_CASE(MemberLearnsLargeSegment) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	fixture.client().setDelegates(1);
+	const Name delegate = outranking(fixture.client().getPrefix(), 1).front();
+	fixture.provision(delegate, 1);
+	BOOST_REQUIRE(fixture.state(delegate) == PierState::CONFIRMED);
+	const size_t registered = fixture.sent("register");
+
+	// The delegate's list of the segment takes several pages.
+	std::vector<PierListEntry> segment;
+	for (size_t i = 0; i < LARGE_SEGMENT; i++) {
+		segment.push_back({Name("/test/member" + std::to_string(i)), 1});
+	}
+	fixture.client().sendGossip();
+	fixture.advance(time::milliseconds(1));
+	size_t pages = 0;
+	for (size_t answered = 1; answered > 0;) {
+		answered = fixture.answerGossip(delegate, segment);
+		pages += answered;
+	}
+	BOOST_CHECK_GT(pages, 1U);
+	BOOST_CHECK_EQUAL(fixture.sent("register") - registered, LARGE_SEGMENT);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ahnd
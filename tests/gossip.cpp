@@ -0,0 +1,88 @@
+#include "clientfixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+// More than fit one packet, and more than a single page may carry.
+constexpr size_t LONG_LIST = 600;
+
+static auto members(const std::string &base, const size_t count)
+    -> std::vector<PierListEntry> {
+	std::vector<PierListEntry> entries;
+	for (size_t i = 0; i < count; i++) {
+		entries.push_back({Name(base + std::to_string(i)), 1});
+	}
+	return entries;
+}
+
+BOOST_AUTO_TEST_SUITE(Gossip)
+
+BOOST_AUTO_TEST_CASE(PagesFitPackets) {
+	const auto entries = members("/test/segment/member", LONG_LIST);
+	size_t offset = 0;
+	size_t pages = 0;
+	size_t total = 0;
+	do {
+		const PierList page =
+		    PierList::page(1, entries, offset, MAX_NDN_PACKET_SIZE / 2);
+		BOOST_CHECK_EQUAL(page.offset(), offset);
+		BOOST_CHECK_LE(page.wireEncode().size(), MAX_NDN_PACKET_SIZE / 2);
+		const PierList decoded(page.wireEncode());
+		BOOST_CHECK_EQUAL(decoded.entries().size(), page.entries().size());
+		BOOST_CHECK_EQUAL(decoded.next(), page.next());
+		total += page.entries().size();
+		offset = page.next();
+		pages++;
+	} while (offset != 0);
+	BOOST_CHECK_EQUAL(total, LONG_LIST);
+	BOOST_CHECK_GT(pages, 2U);
+}
+
+BOOST_AUTO_TEST_CASE(LongListIsPulledInPages) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name pier("/test/pier");
+	fixture.provision(pier, 1);
+	BOOST_REQUIRE(fixture.state(pier) == PierState::CONFIRMED);
+	const size_t registered = fixture.sent("register");
+
+	const auto entries = members("/test/far/member", LONG_LIST);
+	fixture.client().sendGossip();
+	fixture.advance(time::milliseconds(1));
+	size_t requests = 0;
+	for (size_t answered = 1; answered > 0;) {
+		answered = fixture.answerGossip(pier, entries);
+		requests += answered;
+	}
+	BOOST_CHECK_GT(requests, 1U);
+	// A route for every entry, from every page.
+	BOOST_CHECK_EQUAL(fixture.sent("register") - registered, LONG_LIST);
+}
+
+BOOST_AUTO_TEST_CASE(LongListIsServedInPages) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name source("/test/source");
+	const Name requester("/test/requester");
+	fixture.provision(source, 1);
+	fixture.provision(requester, 2);
+	const auto entries = members("/test/far/member", LONG_LIST);
+	fixture.client().sendGossip();
+	fixture.advance(time::milliseconds(1));
+	while (fixture.answerGossip(source, entries) > 0) {
+	}
+
+	// Everything learned from the source and both direct piers, split
+	// horizon only leaves out routes through the requester.
+	const auto pulled = fixture.pullGossip(requester);
+	BOOST_CHECK_EQUAL(pulled.size(), LONG_LIST + 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ahnd
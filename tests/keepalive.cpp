@@ -0,0 +1,71 @@
+#include "clientfixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(KeepAlive)
+
+static auto shortTiming() -> Timing {
+	Timing timing;
+	timing.interestLifetimeMs = 1000;
+	timing.suspectProbeSeconds = 2;
+	return timing;
+}
+
+BOOST_AUTO_TEST_CASE(UnansweredPierIsRemoved) {
+	ClientFixture fixture(shortTiming());
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name pier("/test/pier");
+	fixture.provision(pier, 1);
+	BOOST_REQUIRE(fixture.state(pier) == PierState::CONFIRMED);
+	BOOST_CHECK_EQUAL(fixture.up.size(), 1U);
+
+	fixture.client().sendKeepAliveInterest();
+	fixture.advance(time::milliseconds(1));
+	BOOST_CHECK_EQUAL(fixture.sent("nd-keepalive"), 1U);
+	// One lost keepalive only makes the pier suspect.
+	fixture.advance(time::milliseconds(1100));
+	BOOST_CHECK(fixture.state(pier) == PierState::SUSPECT);
+	BOOST_CHECK(fixture.down.empty());
+
+	// The probe goes out suspectProbeSeconds later and times out as well.
+	fixture.advance(time::seconds(2));
+	BOOST_CHECK_EQUAL(fixture.sent("nd-keepalive"), 2U);
+	fixture.advance(time::milliseconds(1100));
+	BOOST_CHECK(!fixture.hasPier(pier));
+	BOOST_REQUIRE_EQUAL(fixture.down.size(), 1U);
+	BOOST_CHECK_EQUAL(fixture.down.front(), pier);
+}
+
+BOOST_AUTO_TEST_CASE(AnsweredProbeClearsSuspect) {
+	ClientFixture fixture(shortTiming());
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name pier("/test/pier");
+	fixture.provision(pier, 1);
+
+	fixture.client().sendKeepAliveInterest();
+	fixture.advance(time::milliseconds(1100));
+	BOOST_REQUIRE(fixture.state(pier) == PierState::SUSPECT);
+	fixture.advance(time::seconds(2));
+	fixture.answerKeepAlives();
+	BOOST_CHECK(fixture.state(pier) == PierState::CONFIRMED);
+
+	// Hours of answered keepalive rounds keep it up.
+	for (int round = 0; round < 24; round++) {
+		fixture.client().sendKeepAliveInterest();
+		fixture.advance(time::milliseconds(1));
+		fixture.answerKeepAlives();
+		fixture.advance(time::seconds(shortTiming().keepaliveSeconds));
+	}
+	BOOST_CHECK(fixture.state(pier) == PierState::CONFIRMED);
+	BOOST_CHECK(fixture.down.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ahnd
@@ -0,0 +1,114 @@
+#include "clientfixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <arpa/inet.h>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(PierLifecycle)
+
+BOOST_AUTO_TEST_CASE(AnnouncedPierIsConfirmed) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name prefix("/test/pier");
+	fixture.announce(prefix, 1);
+	BOOST_CHECK(fixture.state(prefix) == PierState::FACE_PENDING);
+	fixture.answerCommands();
+	BOOST_CHECK(fixture.state(prefix) == PierState::ROUTE_PENDING);
+	BOOST_CHECK_GT(fixture.pier(prefix).faceId, 0);
+	fixture.answerCommands();
+	BOOST_CHECK(fixture.state(prefix) == PierState::CONFIRMED);
+	BOOST_REQUIRE_EQUAL(fixture.up.size(), 1U);
+	BOOST_CHECK_EQUAL(fixture.up.front(), prefix);
+}
+
+BOOST_AUTO_TEST_CASE(RepeatedAnnouncementsAreCoalesced) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name prefix("/test/pier");
+	// Our own prefixes were registered on start.
+	const size_t registered = fixture.sent("register");
+	fixture.announce(prefix, 1);
+	fixture.announce(prefix, 1);
+	fixture.arrive(prefix, 1);
+	BOOST_CHECK_EQUAL(fixture.sent("create"), 1U);
+	fixture.answerCommands();
+	fixture.announce(prefix, 1);
+	BOOST_CHECK_EQUAL(fixture.sent("register"), registered + 1);
+	fixture.answerCommands();
+	BOOST_CHECK(fixture.state(prefix) == PierState::CONFIRMED);
+	BOOST_CHECK_EQUAL(fixture.sent("create"), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(UnansweredFaceCreationIsRetried) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name prefix("/test/pier");
+	fixture.announce(prefix, 1);
+	BOOST_CHECK_EQUAL(fixture.sent("create"), 1U);
+
+	// The command times out and the retry waits at most a second.
+	fixture.advance(time::seconds(6));
+	BOOST_CHECK_EQUAL(fixture.sent("create"), 2U);
+	BOOST_CHECK(fixture.state(prefix) == PierState::FACE_PENDING);
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_CHECK(fixture.state(prefix) == PierState::CONFIRMED);
+}
+
+BOOST_AUTO_TEST_CASE(DepartureTearsDown) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name prefix("/test/pier");
+	fixture.provision(prefix, 1);
+	BOOST_REQUIRE(fixture.state(prefix) == PierState::CONFIRMED);
+
+	fixture.depart(prefix, 1);
+	BOOST_CHECK(!fixture.hasPier(prefix));
+	BOOST_REQUIRE_EQUAL(fixture.down.size(), 1U);
+	BOOST_CHECK_EQUAL(fixture.down.front(), prefix);
+	// The route goes first, then the face.
+	BOOST_CHECK_EQUAL(fixture.sent("unregister"), 1U);
+	fixture.answerCommands();
+	BOOST_CHECK_EQUAL(fixture.sent("destroy"), 1U);
+}
+
+// An address next to ours, on our subnet for any netmask up to /30.
+static auto neighbour(in_addr ip, const uint32_t flip) -> in_addr {
+	ip.s_addr = htonl(ntohl(ip.s_addr) ^ flip);
+	return ip;
+}
+
+BOOST_AUTO_TEST_CASE(MovedPierGoesDownThenUp) {
+	ClientFixture fixture;
+	if (fixture.client().getIp().s_addr == 0) {
+		BOOST_TEST_MESSAGE("No IPv4 address, piers can not move");
+		return;
+	}
+	const Name prefix("/test/pier");
+	fixture.announceFrom(prefix, neighbour(fixture.client().getIp(), 1));
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_REQUIRE(fixture.state(prefix) == PierState::CONFIRMED);
+	BOOST_REQUIRE_EQUAL(fixture.up.size(), 1U);
+
+	// Renumbered on the same link, it moves to a new face.
+	fixture.announceFrom(prefix, neighbour(fixture.client().getIp(), 2));
+	BOOST_REQUIRE_EQUAL(fixture.down.size(), 1U);
+	BOOST_CHECK_EQUAL(fixture.up.size(), 1U);
+	fixture.answerCommands();
+	fixture.answerCommands();
+	fixture.answerCommands();
+	BOOST_CHECK(fixture.state(prefix) == PierState::CONFIRMED);
+	BOOST_CHECK_EQUAL(fixture.up.size(), 2U);
+	BOOST_CHECK_EQUAL(fixture.down.size(), 1U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ahnd
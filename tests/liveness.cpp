@@ -0,0 +1,75 @@
+#include "clientfixture.h"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(PassiveLiveness)
+
+static auto passiveTiming() -> Timing {
+	Timing timing;
+	timing.passiveLiveness = 1;
+	return timing;
+}
+
+// Run a keepalive round, the face counters read from the fixture's NFD.
+static void keepAliveRound(ClientFixture &fixture) {
+	fixture.client().sendKeepAliveInterest();
+	fixture.advance(time::milliseconds(1));
+	fixture.answerFaceDataset();
+	fixture.answerKeepAlives();
+}
+
+BOOST_AUTO_TEST_CASE(ArrivalsDoNotCount) {
+	ClientFixture fixture(passiveTiming());
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name pier("/test/pier");
+	fixture.provision(pier, 1);
+	BOOST_REQUIRE(fixture.state(pier) == PierState::CONFIRMED);
+	// Past the nd-info that set the pier up.
+	fixture.advance(time::seconds(passiveTiming().keepaliveSeconds));
+
+	// Every member hears the pier's multicast heartbeat, it says nothing
+	// about the face to it.
+	fixture.arrive(pier, 1);
+	keepAliveRound(fixture);
+	BOOST_CHECK_EQUAL(fixture.sent("nd-keepalive"), 1U);
+}
+
+BOOST_AUTO_TEST_CASE(KeepAliveFromPierCounts) {
+	ClientFixture fixture(passiveTiming());
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name pier("/test/pier");
+	fixture.provision(pier, 1);
+	fixture.advance(time::seconds(passiveTiming().keepaliveSeconds));
+
+	fixture.keepAliveFrom(pier);
+	keepAliveRound(fixture);
+	BOOST_CHECK_EQUAL(fixture.sent("nd-keepalive"), 0U);
+
+	// A keepalive period later without a word from the pier it is probed.
+	fixture.advance(time::seconds(passiveTiming().keepaliveSeconds));
+	keepAliveRound(fixture);
+	BOOST_CHECK_EQUAL(fixture.sent("nd-keepalive"), 1U);
+	BOOST_CHECK(fixture.state(pier) == PierState::CONFIRMED);
+}
+
+BOOST_AUTO_TEST_CASE(NdInfoCounts) {
+	ClientFixture fixture(passiveTiming());
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name pier("/test/pier");
+	fixture.provision(pier, 1);
+	fixture.advance(time::seconds(passiveTiming().keepaliveSeconds));
+
+	fixture.announce(pier, 1);
+	keepAliveRound(fixture);
+	BOOST_CHECK_EQUAL(fixture.sent("nd-keepalive"), 0U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ahnd
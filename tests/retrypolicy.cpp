@@ -0,0 +1,140 @@
+#include "clientfixture.h"
+#include "retrypolicy.h"
+#include "virtualclock.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+using namespace ndn;
+
+namespace ahnd {
+namespace tests {
+
+// A RetryPolicy on its own scheduler, reporting how long retries waited.
+class RetryFixture {
+  private:
+	boost::asio::io_service m_io;
+	VirtualClock m_clock;
+	Scheduler m_scheduler;
+
+  public:
+	RetryPolicy policy;
+
+	explicit RetryFixture(size_t budget = 32)
+	    : m_clock(m_io), m_scheduler(m_io), policy(m_scheduler, budget) {}
+
+	// The wait before retry number attempt + 1 of op runs.
+	auto wait(const RetryOp op, const int attempt) -> time::milliseconds {
+		const auto start = time::steady_clock::now();
+		auto ran = start;
+		policy.schedule(op, attempt,
+		                [&ran] { ran = time::steady_clock::now(); });
+		while (ran == start) {
+			m_clock.advance(time::milliseconds(1));
+		}
+		return time::duration_cast<time::milliseconds>(ran - start);
+	}
+
+	void advance(const time::nanoseconds duration) {
+		m_clock.advance(duration, time::milliseconds(10));
+	}
+};
+
+BOOST_AUTO_TEST_SUITE(Retries)
+
+BOOST_AUTO_TEST_CASE(BackoffDoublesUpToCap) {
+	RetryFixture fixture;
+	const RetryLimits limits = retryLimits(RetryOp::FACE);
+	for (int attempt = 0; attempt < 8; attempt++) {
+		const long full = std::min(limits.baseMs << attempt, limits.maxMs);
+		const long waited = fixture.wait(RetryOp::FACE, attempt).count();
+		// Jitter keeps it in the upper half.
+		BOOST_CHECK_GE(waited, full / 2);
+		BOOST_CHECK_LE(waited, full + 1);
+	}
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(CancelledRetryIsNotPending) {
+	RetryFixture fixture;
+	scheduler::ScopedEventId retry =
+	    fixture.policy.schedule(RetryOp::ROUTE, 0, [] {});
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), 1U);
+	retry.cancel();
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(BudgetCapsWaitingRetries) {
+	constexpr size_t BUDGET = 2;
+	constexpr int RETRIES = 5;
+	RetryFixture fixture(BUDGET);
+	std::vector<int> ran;
+	for (int i = 0; i < RETRIES; i++) {
+		fixture.policy.schedule(RetryOp::FACE, 0,
+		                        [&ran, i] { ran.push_back(i); });
+	}
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), BUDGET);
+	BOOST_CHECK_EQUAL(fixture.policy.queued(), RETRIES - BUDGET);
+	// Never more than the budget waiting, the rest start as those run.
+	for (int ms = 0; ms < RETRIES * 1000; ms += 10) {
+		fixture.advance(time::milliseconds(10));
+		BOOST_REQUIRE_LE(fixture.policy.pending(), BUDGET);
+	}
+	BOOST_REQUIRE_EQUAL(ran.size(), static_cast<size_t>(RETRIES));
+	// The queued ones only started their backoff once the first two ran.
+	BOOST_CHECK_EQUAL(std::min(ran.at(0), ran.at(1)), 0);
+	BOOST_CHECK_EQUAL(std::max(ran.at(0), ran.at(1)), 1);
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), 0U);
+	BOOST_CHECK_EQUAL(fixture.policy.queued(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(CancelledQueuedRetryDoesNotRun) {
+	RetryFixture fixture(1);
+	bool first = false;
+	bool second = false;
+	fixture.policy.schedule(RetryOp::ROUTE, 0, [&first] { first = true; });
+	scheduler::ScopedEventId queued = fixture.policy.schedule(
+	    RetryOp::ROUTE, 0, [&second] { second = true; });
+	BOOST_CHECK_EQUAL(fixture.policy.queued(), 1U);
+	queued.cancel();
+	BOOST_CHECK_EQUAL(fixture.policy.queued(), 0U);
+	fixture.advance(time::seconds(5));
+	BOOST_CHECK(first);
+	BOOST_CHECK(!second);
+}
+
+BOOST_AUTO_TEST_CASE(CancelledRetryMakesRoom) {
+	RetryFixture fixture(1);
+	bool second = false;
+	scheduler::ScopedEventId waiting =
+	    fixture.policy.schedule(RetryOp::ROUTE, 0, [] {});
+	fixture.policy.schedule(RetryOp::ROUTE, 0, [&second] { second = true; });
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), 1U);
+	BOOST_CHECK_EQUAL(fixture.policy.queued(), 1U);
+	waiting.cancel();
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), 1U);
+	BOOST_CHECK_EQUAL(fixture.policy.queued(), 0U);
+	fixture.advance(time::seconds(2));
+	BOOST_CHECK(second);
+	BOOST_CHECK_EQUAL(fixture.policy.pending(), 0U);
+}
+
+BOOST_AUTO_TEST_CASE(ClientGivesUpOnFace) {
+	ClientFixture fixture;
+	BOOST_REQUIRE(fixture.canAnnounce());
+	const Name prefix("/test/pier");
+	fixture.announce(prefix, 1);
+	// Every faces/create times out, the backoff runs to its cap and the
+	// pier is dropped after the last retry.
+	fixture.advance(time::minutes(3));
+	const RetryLimits limits = retryLimits(RetryOp::FACE);
+	BOOST_CHECK_EQUAL(fixture.sent("create"),
+	                  static_cast<size_t>(limits.maxRetries + 1));
+	BOOST_CHECK(!fixture.hasPier(prefix));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+} // namespace tests
+} // namespace ahnd